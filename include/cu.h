@@ -4,6 +4,9 @@
 #include "cu_mem.h"
 #include "cu_math.h"
 #include "cu_io.h"
+#include "cu_str.h"
+#include "cu_compress.h"
+#include "cu_sort.h"
 
 #if defined(__GNUC__) || defined(__clang__)
 #define WARN_UNUSED_RESULT __attribute__((warn_unused_result))
@@ -0,0 +1,29 @@
+#ifndef CU_COMPRESS_H
+#define CU_COMPRESS_H
+
+#include "cu_mem.h"
+
+// Data is compressed as a single LZ4 block, preceded by a frame header holding the sizes and a checksum of the uncompressed data.
+// The header is stored in native byte order, so compressed data isn't portable across endianness.
+
+#define LZ_FRAME_MAGIC 0x5A4C5543 // "CULZ"
+
+typedef struct {
+    t_u32 magic;
+    t_u32 reserved;
+    t_u64 uncompressed_size;
+    t_u64 compressed_size;
+    t_u64 checksum; // HashBytes64 of the uncompressed data.
+} s_lz_frame_header;
+
+size_t LZCompressBound(const size_t src_size); // The most space the framed result of compressing data of the given size can take up. Compression fails if this exceeds INT32_MAX.
+
+s_u8_array CompressLZ(const s_u8_array_view src, s_mem_arena* const mem_arena, s_mem_arena* const temp_mem_arena);
+
+// Decompresses straight into memory pushed to the arena. Fails on malformed data or a checksum mismatch.
+s_u8_array DecompressLZ(const s_u8_array_view frame, s_mem_arena* const mem_arena, const bool include_terminating_byte);
+
+bool SaveFileCompressed(const s_char_array_view file_path, const s_u8_array_view contents, s_mem_arena* const temp_mem_arena);
+s_u8_array LoadFileCompressed(const s_char_array_view file_path, s_mem_arena* const mem_arena, s_mem_arena* const temp_mem_arena, const bool include_terminating_byte);
+
+#endif
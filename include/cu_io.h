@@ -3,9 +3,12 @@
 
 #include <stdbool.h>
 #include <stdio.h>
-#include <direct.h>
 #include "cu_mem.h"
 
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
 #define ANSI_ESC "\x1b"
 
 #define ANSI_RESET ANSI_ESC "[0m"
@@ -64,8 +67,102 @@ DEF_ARRAY_TYPE(t_filename_buf, filename_buf, FilenameBuf);
 bool DoesFilenameHaveExt(const s_char_array_view filename, const s_char_array_view ext);
 bool LoadDirFilenames(s_filename_buf_array* const filename_bufs, s_mem_arena* const mem_arena, const s_char_array_view dir_param);
 
+#define DIR_WALK_THREAD_LIMIT 64
+
+typedef enum {
+    ek_dir_entry_type_file,
+    ek_dir_entry_type_dir,
+    ek_dir_entry_type_other // Symbolic links, devices, etc. These are never followed.
+} e_dir_entry_type;
+
+typedef struct {
+    t_s32 name_offs; // Offset of the terminated name in the packed name table of the tree.
+    t_s32 parent_index; // -1 if the entry is directly inside the walked directory.
+    e_dir_entry_type type;
+    t_u64 size; // Always 0 for non-files, or if sizes weren't requested.
+} s_dir_entry;
+
+DEF_ARRAY_TYPE(s_dir_entry, dir_entry, DirEntry);
+
+typedef struct {
+    s_dir_entry_array entries; // The children of a directory are always stored contiguously.
+    s_char_array names;
+} s_dir_tree;
+
+typedef struct {
+    s_char_array_view ext; // If set, only files with this extension (e.g. ".png") are kept. Directories are always kept.
+    bool recursive;
+    bool load_sizes; // On POSIX this costs an fstatat() call per regular file, since directory listings don't carry sizes. Windows gets sizes for free.
+    t_s32 thread_cnt; // Subdirectories of the walked directory are fanned out across this many threads. 0 or 1 means no extra threads.
+} s_dir_walk_options;
+
+// Entries and names are written to the given memory arena. The free space of the temporary memory arena is shared by the threads for intermediate storage, claimed in chunks as needed, and is left as it was on return.
+bool WalkDir(s_dir_tree* const tree, s_mem_arena* const mem_arena, s_mem_arena* const temp_mem_arena, const s_char_array_view dir_path, const s_dir_walk_options options);
+
+// Writes the path of the entry relative to the walked directory into the given buffer. Returns false if the buffer is too small.
+bool LoadDirEntryPath(char* const buf, const size_t buf_size, const s_dir_tree* const tree, const t_s32 entry_index);
+
+static inline const char* DirEntryName(const s_dir_tree* const tree, const t_s32 entry_index) {
+    return CharElem(tree->names, DirEntryElem(tree->entries, entry_index)->name_offs);
+}
+
+#define MEM_ARENA_SNAPSHOT_MAGIC 0x53415543 // "CUAS"
+#define MEM_ARENA_SNAPSHOT_HEADER_SIZE 64 // Padded so that the alignment of anything pushed to the arena carries over to the mapped data.
+
+typedef struct {
+    t_u32 magic;
+    t_u32 version; // Supplied by the user, to reject snapshots of an outdated layout.
+    t_u64 data_size;
+    t_u64 checksum; // HashBytes64 of the data.
+} s_mem_arena_snapshot_header;
+
+static_assert(sizeof(s_mem_arena_snapshot_header) <= MEM_ARENA_SNAPSHOT_HEADER_SIZE, "Snapshot header too large!");
+
+typedef struct {
+    const t_u8* data; // Starts with the first byte of the arena the snapshot was taken of. Read-only.
+    size_t data_size;
+
+    void* map;
+    size_t map_size;
+} s_mem_arena_snapshot;
+
+// Writes the used region of the arena out. Any pointers inside of it should be stored as relative pointers or relative arrays.
+bool SaveMemArenaSnapshot(const s_mem_arena* const arena, const s_char_array_view file_path, const t_u32 version);
+bool MapMemArenaSnapshot(s_mem_arena_snapshot* const snapshot, const s_char_array_view file_path, const t_u32 version, const bool verify_checksum);
+void UnmapMemArenaSnapshot(s_mem_arena_snapshot* const snapshot);
+
 s_u8_array LoadFileContents(const s_char_array_view file_path, s_mem_arena* const mem_arena, const bool include_terminating_byte);
 
+typedef struct {
+    s_char_array_view path;
+    s_u8_array_view contents; // Always followed by a terminating byte, which isn't included in the count.
+    t_u64 hash; // HashBytes64 of the contents.
+    t_u32 version; // Incremented whenever the contents change.
+
+    t_u64 path_hash;
+    t_u64 mtime_ns;
+    t_u64 size;
+    size_t contents_cap;
+    int watch_desc; // -1 if the file isn't being watched.
+    bool stale;
+} s_file_cache_entry;
+
+// Files are keyed by path in a fixed-capacity hash table. Contents live in the memory arena, and are overwritten in place when a changed file still fits.
+// Without watching, each load is revalidated by comparing the modification time and size. With watching (Linux only, through inotify), a load of an unchanged file makes no filesystem calls.
+typedef struct {
+    s_mem_arena* mem_arena;
+    s_file_cache_entry* entries;
+    t_s32 cap;
+    t_s32 entry_cnt;
+    int inotify_fd; // -1 if not watching.
+} s_file_cache;
+
+bool InitFileCache(s_file_cache* const cache, s_mem_arena* const mem_arena, const t_s32 cap, const bool watch);
+void CleanFileCache(s_file_cache* const cache);
+
+// Returns NULL on failure. The entry pointer stays valid for the lifetime of the cache.
+const s_file_cache_entry* LoadFileCached(s_file_cache* const cache, const s_char_array_view file_path);
+
 static inline s_char_array LoadFileContentsAsStr(const s_char_array_view file_path, s_mem_arena* const mem_arena) {
     const s_u8_array contents = LoadFileContents(file_path, mem_arena, true);
     return (s_char_array){.buf_raw = (char*)contents.buf_raw, .elem_cnt = contents.elem_cnt};
@@ -5,6 +5,10 @@
 #include <assert.h>
 #include "cu_mem.h"
 
+#ifdef SIMD_BMI2
+#include <immintrin.h>
+#endif
+
 #define PI 3.14159265358979323846f
 #define TAU 6.28318530717958647692f
 
@@ -270,6 +274,361 @@ static inline bool IsRangeS32Valid(const s_rect_edges_s32 range, const s_v2_s32
         && range.top <= range.bottom;
 }
 
+static inline t_u32 MortonEncode2D(const t_u32 x, const t_u32 y) {
+    assert(x <= 0xFFFF && y <= 0xFFFF);
+
+#ifdef SIMD_BMI2
+    return _pdep_u32(x, 0x55555555) | _pdep_u32(y, 0xAAAAAAAA);
+#else
+    t_u32 xy[2] = {x, y};
+
+    for (t_s32 i = 0; i < 2; i++) {
+        t_u32 n = xy[i];
+        n = (n | (n << 8)) & 0x00FF00FF;
+        n = (n | (n << 4)) & 0x0F0F0F0F;
+        n = (n | (n << 2)) & 0x33333333;
+        n = (n | (n << 1)) & 0x55555555;
+        xy[i] = n;
+    }
+
+    return xy[0] | (xy[1] << 1);
+#endif
+}
+
+static inline s_v2_s32 MortonDecode2D(const t_u32 code) {
+#ifdef SIMD_BMI2
+    return (s_v2_s32){(t_s32)_pext_u32(code, 0x55555555), (t_s32)_pext_u32(code, 0xAAAAAAAA)};
+#else
+    t_u32 xy[2] = {code, code >> 1};
+
+    for (t_s32 i = 0; i < 2; i++) {
+        t_u32 n = xy[i] & 0x55555555;
+        n = (n | (n >> 1)) & 0x33333333;
+        n = (n | (n >> 2)) & 0x0F0F0F0F;
+        n = (n | (n >> 4)) & 0x00FF00FF;
+        n = (n | (n >> 8)) & 0x0000FFFF;
+        xy[i] = n;
+    }
+
+    return (s_v2_s32){(t_s32)xy[0], (t_s32)xy[1]};
+#endif
+}
+
+// The smallest Morton code above the given one whose point lies within the box spanned by the given corner codes (the BIGMIN of Tropf and Herzog).
+// Works because interleaving bits preserves the ordering of each coordinate.
+static inline t_u32 MortonNextInBox(const t_u32 code, t_u32 min_code, t_u32 max_code) {
+    t_u32 next = 0;
+
+    // All codes in between agree with both corners on the bits above the highest one where the corners differ.
+    t_s32 bit_high = 31;
+
+    while (bit_high > 0 && !((min_code ^ max_code) & ((t_u32)1 << bit_high))) {
+        bit_high--;
+    }
+
+    for (t_s32 bit = bit_high; bit >= 0; bit--) {
+        const t_u32 mask = (t_u32)1 << bit;
+
+        // This bit and the lower bits of the same coordinate.
+        const t_u32 coord_mask = (mask | (mask - 1)) & ((bit & 1) ? 0xAAAAAAAA : 0x55555555);
+
+        const bool code_bit = code & mask;
+        const bool min_bit = min_code & mask;
+        const bool max_bit = max_code & mask;
+
+        if (!code_bit && !min_bit && max_bit) {
+            next = (min_code & ~coord_mask) | mask;
+            max_code = (max_code & ~coord_mask) | (coord_mask & ~mask);
+        } else if (!code_bit && min_bit && max_bit) {
+            return min_code;
+        } else if (code_bit && !min_bit && !max_bit) {
+            return next;
+        } else if (code_bit && !min_bit && max_bit) {
+            min_code = (min_code & ~coord_mask) | mask;
+        }
+    }
+
+    return next;
+}
+
+typedef enum {
+    ek_grid_layout_row_major,
+    ek_grid_layout_tiled, // Row-major blocks of GRID_TILE_SIZE x GRID_TILE_SIZE elements, each block row-major inside.
+    ek_grid_layout_morton // Z-order over the size padded out to a power-of-two square, so best suited to square grids.
+} e_grid_layout;
+
+#define GRID_TILE_SIZE_LOG2 3
+#define GRID_TILE_SIZE (1 << GRID_TILE_SIZE_LOG2)
+
+typedef struct {
+    s_v2_s32 size;
+    e_grid_layout layout;
+    t_s32 tiles_per_row;
+    t_s32 elem_cnt; // Includes any padding required by the layout.
+} s_grid_dims;
+
+static inline s_grid_dims GridDims(const s_v2_s32 size, const e_grid_layout layout) {
+    assert(size.x > 0 && size.y > 0);
+
+    s_grid_dims dims = {.size = size, .layout = layout};
+
+    switch (layout) {
+        case ek_grid_layout_row_major:
+            dims.elem_cnt = size.x * size.y;
+            break;
+
+        case ek_grid_layout_tiled:
+            dims.tiles_per_row = (size.x + GRID_TILE_SIZE - 1) >> GRID_TILE_SIZE_LOG2;
+            dims.elem_cnt = dims.tiles_per_row * ((size.y + GRID_TILE_SIZE - 1) >> GRID_TILE_SIZE_LOG2) * GRID_TILE_SIZE * GRID_TILE_SIZE;
+            break;
+
+        case ek_grid_layout_morton:
+            {
+                assert(size.x <= 32768 && size.y <= 32768);
+
+                t_s32 side = 1;
+
+                while (side < size.x || side < size.y) {
+                    side <<= 1;
+                }
+
+                dims.elem_cnt = side * side;
+            }
+
+            break;
+    }
+
+    return dims;
+}
+
+static inline t_s32 GridIndex(const s_grid_dims dims, const t_s32 x, const t_s32 y) {
+    assert(x >= 0 && x < dims.size.x && y >= 0 && y < dims.size.y);
+
+    switch (dims.layout) {
+        case ek_grid_layout_tiled:
+            {
+                const t_s32 tile_index = ((y >> GRID_TILE_SIZE_LOG2) * dims.tiles_per_row) + (x >> GRID_TILE_SIZE_LOG2);
+                const t_s32 inner_index = ((y & (GRID_TILE_SIZE - 1)) << GRID_TILE_SIZE_LOG2) + (x & (GRID_TILE_SIZE - 1));
+                return (tile_index << (2 * GRID_TILE_SIZE_LOG2)) + inner_index;
+            }
+
+        case ek_grid_layout_morton:
+            return (t_s32)MortonEncode2D(x, y);
+
+        default:
+            return (dims.size.x * y) + x;
+    }
+}
+
+// Visits the elements of a region in the order they are laid out in memory: row by row for row-major grids, tile by tile for tiled grids, and in Z-order for Morton grids.
+typedef struct {
+    s_grid_dims dims;
+    s_rect_edges_s32 region;
+    s_v2_s32 tile_pos;
+    s_v2_s32 pos;
+
+    // Morton grids step through the codes directly, skipping past runs which fall outside of the region.
+    t_u32 morton_code;
+    t_u32 morton_min_code;
+    t_u32 morton_max_code;
+
+    bool done;
+} s_grid_region_iter;
+
+static inline s_grid_region_iter GridRegionIter(const s_grid_dims dims, const s_rect_edges_s32 region) {
+    const s_rect_edges_s32 region_clamped = RectEdgesS32Clamped(region, (s_rect_edges_s32){0, 0, dims.size.x, dims.size.y});
+
+    s_grid_region_iter iter = {
+        .dims = dims,
+        .region = region_clamped,
+        .pos = {region_clamped.left, region_clamped.top},
+        .done = region_clamped.left >= region_clamped.right || region_clamped.top >= region_clamped.bottom
+    };
+
+    if (dims.layout == ek_grid_layout_tiled) {
+        iter.tile_pos = (s_v2_s32){region_clamped.left & ~(GRID_TILE_SIZE - 1), region_clamped.top & ~(GRID_TILE_SIZE - 1)};
+    } else if (dims.layout == ek_grid_layout_morton) {
+        if (!iter.done) {
+            iter.morton_min_code = MortonEncode2D(region_clamped.left, region_clamped.top);
+            iter.morton_max_code = MortonEncode2D(region_clamped.right - 1, region_clamped.bottom - 1);
+            iter.morton_code = iter.morton_min_code;
+        }
+    } else {
+        // Treating the whole region as one tile means plain row-by-row iteration.
+        iter.tile_pos = iter.pos;
+    }
+
+    return iter;
+}
+
+static inline bool NextGridRegionElem(s_grid_region_iter* const iter, t_s32* const index, s_v2_s32* const pos) {
+    if (iter->done) {
+        return false;
+    }
+
+    if (iter->dims.layout == ek_grid_layout_morton) {
+        *index = (t_s32)iter->morton_code;
+        *pos = MortonDecode2D(iter->morton_code);
+
+        if (iter->morton_code == iter->morton_max_code) {
+            iter->done = true;
+            return true;
+        }
+
+        // Comparing the coordinates while still interleaved, since that keeps their ordering.
+        const t_u32 next_code = iter->morton_code + 1;
+        const t_u32 x_bits = next_code & 0x55555555;
+        const t_u32 y_bits = next_code & 0xAAAAAAAA;
+
+        const bool in_region = x_bits >= (iter->morton_min_code & 0x55555555) && x_bits <= (iter->morton_max_code & 0x55555555)
+            && y_bits >= (iter->morton_min_code & 0xAAAAAAAA) && y_bits <= (iter->morton_max_code & 0xAAAAAAAA);
+
+        iter->morton_code = in_region ? next_code : MortonNextInBox(iter->morton_code, iter->morton_min_code, iter->morton_max_code);
+
+        return true;
+    }
+
+    *pos = iter->pos;
+    *index = GridIndex(iter->dims, iter->pos.x, iter->pos.y);
+
+    const s_rect_edges_s32 region = iter->region;
+    const t_s32 tile_size = iter->dims.layout == ek_grid_layout_tiled ? GRID_TILE_SIZE : INT32_MAX / 2;
+    const t_s32 tile_right = MIN(iter->tile_pos.x + tile_size, region.right);
+    const t_s32 tile_bottom = MIN(iter->tile_pos.y + tile_size, region.bottom);
+
+    iter->pos.x++;
+
+    if (iter->pos.x < tile_right) {
+        return true;
+    }
+
+    iter->pos.x = MAX(iter->tile_pos.x, region.left);
+    iter->pos.y++;
+
+    if (iter->pos.y < tile_bottom) {
+        return true;
+    }
+
+    // Moving on to the next tile.
+    iter->tile_pos.x += tile_size;
+
+    if (iter->tile_pos.x >= region.right) {
+        iter->tile_pos.x = region.left & ~(GRID_TILE_SIZE - 1);
+        iter->tile_pos.y += tile_size;
+
+        if (iter->tile_pos.y >= region.bottom) {
+            iter->done = true;
+            return true;
+        }
+    }
+
+    iter->pos = (s_v2_s32){MAX(iter->tile_pos.x, region.left), MAX(iter->tile_pos.y, region.top)};
+
+    return true;
+}
+
+#define DEF_GRID_TYPE(type, name_snake, name_pascal) \
+    typedef struct { \
+        type* buf_raw; \
+        s_grid_dims dims; \
+    } s_##name_snake##_grid; \
+    \
+    static inline s_##name_snake##_grid Push##name_pascal##GridToMemArena(s_mem_arena* const arena, const s_v2_s32 size, const e_grid_layout layout) { \
+        const s_grid_dims dims = GridDims(size, layout); \
+        type* const buf = PushToMemArena(arena, sizeof(type) * dims.elem_cnt, ALIGN_OF(type)); \
+        \
+        if (!buf) { \
+            return (s_##name_snake##_grid){0}; \
+        } \
+        \
+        return (s_##name_snake##_grid){ \
+            .buf_raw = buf, \
+            .dims = dims \
+        }; \
+    } \
+    \
+    static inline type* name_pascal##GridElem(const s_##name_snake##_grid grid, const t_s32 x, const t_s32 y) { \
+        return &grid.buf_raw[GridIndex(grid.dims, x, y)]; \
+    }
+
+#define RNG_LANE_CNT 4
+
+// xoshiro128 family. Floats come from the "+" scrambler and integers from the "**" one, as recommended by the authors.
+typedef struct {
+    t_u32 state[4];
+
+    // Batch fills run this many extra generators side by side, split off from the main state the first time they are needed.
+    t_u32 lane_state[4][RNG_LANE_CNT];
+    bool lanes_split;
+} s_rng;
+
+void SeedRNG(s_rng* const rng, const t_u64 seed);
+void JumpRNG(s_rng* const rng); // Equivalent to 2^64 calls. Batch fill lanes are spaced out using this, so it should not be used to give threads their own streams.
+void LongJumpRNG(s_rng* const rng); // Equivalent to 2^96 calls, so successive long jumps give each thread its own non-overlapping stream, lanes included.
+
+void FillR32sRand(const s_r32_array array, s_rng* const rng, const t_r32 min, const t_r32 max);
+void FillV2sRand(const s_v2_array array, s_rng* const rng, const s_v2 min, const s_v2 max);
+
+static inline t_u32 RotL32(const t_u32 x, const int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline void AdvanceRNG(s_rng* const rng) {
+    t_u32* const s = rng->state;
+    const t_u32 t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotL32(s[3], 11);
+}
+
+static inline t_u32 RandU32(s_rng* const rng) {
+    const t_u32 result = RotL32(rng->state[1] * 5, 7) * 9;
+    AdvanceRNG(rng);
+    return result;
+}
+
+// Returns a value in [0, 1).
+static inline t_r32 RandR32(s_rng* const rng) {
+    const t_u32 result = rng->state[0] + rng->state[3];
+    AdvanceRNG(rng);
+    return (result >> 8) * (1.0f / 16777216.0f);
+}
+
+// The largest value below max that scaling a random unit value can be allowed to reach, as rounding can otherwise land it on max itself.
+static inline t_r32 RandR32RangeLimit(const t_r32 min, const t_r32 max) {
+    return nextafterf(max, min);
+}
+
+// Returns a value in [min, max), or min if they are equal.
+static inline t_r32 RandR32InRange(s_rng* const rng, const t_r32 min, const t_r32 max) {
+    assert(min <= max);
+    const t_r32 result = min + (RandR32(rng) * (max - min));
+    return result < max ? result : RandR32RangeLimit(min, max);
+}
+
+// Returns a value in [min, max].
+static inline t_s32 RandS32InRange(s_rng* const rng, const t_s32 min, const t_s32 max) {
+    assert(min <= max);
+
+    const t_u32 range = (t_u32)max - (t_u32)min + 1;
+
+    if (range == 0) {
+        return (t_s32)RandU32(rng);
+    }
+
+    return (t_s32)((t_u32)min + (t_u32)(((t_u64)RandU32(rng) * range) >> 32));
+}
+
+static inline s_v2 RandV2InRange(s_rng* const rng, const s_v2 min, const s_v2 max) {
+    const t_r32 x = RandR32InRange(rng, min.x, max.x);
+    const t_r32 y = RandR32InRange(rng, min.y, max.y);
+    return (s_v2){x, y};
+}
+
 typedef struct {
     t_r32 elems[4][4];
 } s_matrix_4x4;
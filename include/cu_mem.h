@@ -23,6 +23,16 @@
 #define ALIGN_OF(x) alignof(x)
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#endif
+
+// MSVC never signals BMI2 support (/arch:AVX2 doesn't guarantee it either), so it has to be opted into by defining CU_USE_BMI2.
+// Note that pdep/pext are microcoded on AMD CPUs before Zen 3 and take hundreds of cycles there, far slower than the plain bit twiddling fallbacks.
+#if defined(__BMI2__) || (defined(_MSC_VER) && defined(CU_USE_BMI2))
+#define SIMD_BMI2
+#endif
+
 typedef int8_t t_s8;
 typedef uint8_t t_u8;
 typedef int16_t t_s16;
@@ -91,13 +101,49 @@ typedef struct {
     t_u8* buf;
     size_t size;
     size_t offs;
+
+    size_t map_size; // Non-zero if the buffer was mapped directly from the OS rather than allocated.
 } s_mem_arena;
 
+typedef enum {
+    ek_mem_arena_huge_pages_none,
+    ek_mem_arena_huge_pages_transparent, // Hints to the OS that it should back the arena with huge pages where it can. Unsupported on Windows.
+    ek_mem_arena_huge_pages_explicit // Requests huge pages from the reserved pool, falling back to transparent ones. On Windows these are large pages, which lock the whole arena in physical memory, need the "Lock pages in memory" privilege, and fall back to normal pages.
+} e_mem_arena_huge_pages;
+
+typedef enum {
+    ek_mem_arena_numa_policy_default, // Pages land on whichever node first touches them.
+    ek_mem_arena_numa_policy_bind,
+    ek_mem_arena_numa_policy_interleave // Spreads pages across all online nodes.
+} e_mem_arena_numa_policy;
+
+typedef struct {
+    e_mem_arena_huge_pages huge_pages;
+    e_mem_arena_numa_policy numa_policy;
+    t_s32 numa_node; // Only used for binding.
+} s_mem_arena_options;
+
 bool InitMemArena(s_mem_arena* const arena, const size_t size);
+bool InitMemArenaWithOptions(s_mem_arena* const arena, const size_t size, const s_mem_arena_options options); // Options that aren't available are skipped with a warning.
 void CleanMemArena(s_mem_arena* const arena);
 void* PushToMemArena(s_mem_arena* const arena, const size_t size, const size_t alignment);
 void RewindMemArena(s_mem_arena* const arena, const size_t rewind_offs);
 
+t_u64 HashBytes64(const void* const data, const size_t size, const t_u64 seed); // xxHash64.
+
+// A pointer stored as an offset from its own address, so that memory containing it can be written out and mapped back in anywhere without any fixup. An offset of 0 represents NULL.
+typedef struct {
+    t_s64 offs;
+} s_rel_ptr;
+
+static inline void* RelPtrGet(const s_rel_ptr* const ptr) {
+    return ptr->offs ? (t_u8*)ptr + ptr->offs : NULL;
+}
+
+static inline void RelPtrSet(s_rel_ptr* const ptr, const void* const target) {
+    ptr->offs = target ? (const t_u8*)target - (const t_u8*)ptr : 0;
+}
+
 #define STATIC_ARRAY_LEN(array) (sizeof(array) / sizeof((array)[0]))
 
 #define STATIC_ARRAY_LEN_CHECK(array, ideal_len) static_assert(STATIC_ARRAY_LEN(array) == (ideal_len), "Invalid static array length!");
@@ -173,6 +219,20 @@ void RewindMemArena(s_mem_arena* const arena, const size_t rewind_offs);
             .buf_raw = buf, \
             .elem_cnt = elem_cnt \
         }; \
+    } \
+    \
+    typedef struct { \
+        s_rel_ptr buf; \
+        t_s32 elem_cnt; \
+    } s_##name_snake##_rel_array; \
+    \
+    static inline s_##name_snake##_array_view name_pascal##RelArrayView(const s_##name_snake##_rel_array* const rel_array) { \
+        return (s_##name_snake##_array_view){.buf_raw = RelPtrGet(&rel_array->buf), .elem_cnt = rel_array->elem_cnt}; \
+    } \
+    \
+    static inline void Set##name_pascal##RelArray(s_##name_snake##_rel_array* const rel_array, const s_##name_snake##_array_view array) { \
+        RelPtrSet(&rel_array->buf, array.buf_raw); \
+        rel_array->elem_cnt = array.elem_cnt; \
     }
 
 #define ARRAY_FROM_STATIC(static_array) {.buf_raw = static_array, .elem_cnt = STATIC_ARRAY_LEN(static_array)}
@@ -192,13 +252,7 @@ static inline s_char_array_view StrViewFromRawTerminated(const char* const raw)
 }
 
 static inline bool IsStrTerminated(const s_char_array_view str) {
-    for (int i = 0; i < str.elem_cnt; i++) {
-        if (!*CharElemView(str, i)) {
-            return true;
-        }
-    }
-
-    return false;
+    return str.elem_cnt > 0 && memchr(str.buf_raw, 0, str.elem_cnt);
 }
 
 DEF_ARRAY_TYPE(s_char_array, char_array, CharArray);
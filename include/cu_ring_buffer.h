@@ -0,0 +1,225 @@
+#ifndef CU_RING_BUFFER_H
+#define CU_RING_BUFFER_H
+
+// Not part of cu.h, as it relies on C11 atomics which MSVC only supports behind /experimental:c11atomics (added by the CMake target).
+
+#include <stdatomic.h>
+#include "cu_mem.h"
+
+#define CACHE_LINE_SIZE 64
+
+// Generates bounded lock-free queues over arena memory:
+// - s_<name>_spsc_ring_buffer, for exactly one producer thread and one consumer thread.
+// - s_<name>_mpmc_ring_buffer, for any number of each (Dmitry Vyukov's bounded queue).
+// Capacities must be powers of two. Each index sits on its own cache line so that producers and consumers don't contend on it.
+// The array type of the element type must already be defined with DEF_ARRAY_TYPE, as it is used for batch pushing and popping.
+#define DEF_RING_BUFFER_TYPE(type, name_snake, name_pascal) \
+    typedef struct { \
+        type* buf; \
+        size_t mask; \
+        \
+        _Alignas(CACHE_LINE_SIZE) atomic_size_t write_index; \
+        size_t read_index_cached; \
+        \
+        _Alignas(CACHE_LINE_SIZE) atomic_size_t read_index; \
+        size_t write_index_cached; \
+    } s_##name_snake##_spsc_ring_buffer; \
+    \
+    static inline bool Init##name_pascal##SPSCRingBuffer(s_##name_snake##_spsc_ring_buffer* const rb, s_mem_arena* const mem_arena, const t_s32 cap) { \
+        assert(IsPowerOfTwo(cap)); \
+        \
+        rb->buf = PushToMemArena(mem_arena, sizeof(type) * cap, ALIGN_OF(type)); \
+        \
+        if (!rb->buf) { \
+            return false; \
+        } \
+        \
+        rb->mask = cap - 1; \
+        atomic_init(&rb->write_index, 0); \
+        atomic_init(&rb->read_index, 0); \
+        rb->read_index_cached = 0; \
+        rb->write_index_cached = 0; \
+        \
+        return true; \
+    } \
+    \
+    static inline t_s32 Push##name_pascal##sToSPSCRingBuffer(s_##name_snake##_spsc_ring_buffer* const rb, const s_##name_snake##_array_view elems) { \
+        const size_t cap = rb->mask + 1; \
+        const size_t write_index = atomic_load_explicit(&rb->write_index, memory_order_relaxed); \
+        \
+        if (write_index - rb->read_index_cached + elems.elem_cnt > cap) { \
+            rb->read_index_cached = atomic_load_explicit(&rb->read_index, memory_order_acquire); \
+        } \
+        \
+        const size_t space = cap - (write_index - rb->read_index_cached); \
+        const size_t cnt = (size_t)elems.elem_cnt < space ? (size_t)elems.elem_cnt : space; \
+        \
+        if (cnt == 0) { \
+            return 0; \
+        } \
+        \
+        const size_t beg = write_index & rb->mask; \
+        const size_t first_cnt = cnt < cap - beg ? cnt : cap - beg; \
+        \
+        memcpy(rb->buf + beg, elems.buf_raw, sizeof(type) * first_cnt); \
+        memcpy(rb->buf, elems.buf_raw + first_cnt, sizeof(type) * (cnt - first_cnt)); \
+        \
+        atomic_store_explicit(&rb->write_index, write_index + cnt, memory_order_release); \
+        \
+        return (t_s32)cnt; \
+    } \
+    \
+    static inline t_s32 Pop##name_pascal##sFromSPSCRingBuffer(s_##name_snake##_spsc_ring_buffer* const rb, const s_##name_snake##_array elems) { \
+        const size_t read_index = atomic_load_explicit(&rb->read_index, memory_order_relaxed); \
+        \
+        if (rb->write_index_cached - read_index < (size_t)elems.elem_cnt) { \
+            rb->write_index_cached = atomic_load_explicit(&rb->write_index, memory_order_acquire); \
+        } \
+        \
+        const size_t avail = rb->write_index_cached - read_index; \
+        const size_t cnt = (size_t)elems.elem_cnt < avail ? (size_t)elems.elem_cnt : avail; \
+        \
+        if (cnt == 0) { \
+            return 0; \
+        } \
+        \
+        const size_t cap = rb->mask + 1; \
+        const size_t beg = read_index & rb->mask; \
+        const size_t first_cnt = cnt < cap - beg ? cnt : cap - beg; \
+        \
+        memcpy(elems.buf_raw, rb->buf + beg, sizeof(type) * first_cnt); \
+        memcpy(elems.buf_raw + first_cnt, rb->buf, sizeof(type) * (cnt - first_cnt)); \
+        \
+        atomic_store_explicit(&rb->read_index, read_index + cnt, memory_order_release); \
+        \
+        return (t_s32)cnt; \
+    } \
+    \
+    static inline bool Push##name_pascal##ToSPSCRingBuffer(s_##name_snake##_spsc_ring_buffer* const rb, const type elem) { \
+        return Push##name_pascal##sToSPSCRingBuffer(rb, (s_##name_snake##_array_view){.buf_raw = &elem, .elem_cnt = 1}) == 1; \
+    } \
+    \
+    static inline bool Pop##name_pascal##FromSPSCRingBuffer(s_##name_snake##_spsc_ring_buffer* const rb, type* const elem) { \
+        return Pop##name_pascal##sFromSPSCRingBuffer(rb, (s_##name_snake##_array){.buf_raw = elem, .elem_cnt = 1}) == 1; \
+    } \
+    \
+    typedef struct { \
+        atomic_size_t seq; \
+        type elem; \
+    } s_##name_snake##_mpmc_ring_buffer_cell; \
+    \
+    typedef struct { \
+        s_##name_snake##_mpmc_ring_buffer_cell* cells; \
+        size_t mask; \
+        \
+        _Alignas(CACHE_LINE_SIZE) atomic_size_t write_index; \
+        _Alignas(CACHE_LINE_SIZE) atomic_size_t read_index; \
+    } s_##name_snake##_mpmc_ring_buffer; \
+    \
+    static inline bool Init##name_pascal##MPMCRingBuffer(s_##name_snake##_mpmc_ring_buffer* const rb, s_mem_arena* const mem_arena, const t_s32 cap) { \
+        assert(IsPowerOfTwo(cap)); \
+        \
+        rb->cells = PushToMemArena(mem_arena, sizeof(*rb->cells) * cap, ALIGN_OF(s_##name_snake##_mpmc_ring_buffer_cell)); \
+        \
+        if (!rb->cells) { \
+            return false; \
+        } \
+        \
+        for (t_s32 i = 0; i < cap; i++) { \
+            atomic_init(&rb->cells[i].seq, i); \
+        } \
+        \
+        rb->mask = cap - 1; \
+        atomic_init(&rb->write_index, 0); \
+        atomic_init(&rb->read_index, 0); \
+        \
+        return true; \
+    } \
+    \
+    static inline t_s32 Push##name_pascal##sToMPMCRingBuffer(s_##name_snake##_mpmc_ring_buffer* const rb, const s_##name_snake##_array_view elems) { \
+        size_t write_index = atomic_load_explicit(&rb->write_index, memory_order_relaxed); \
+        size_t cnt; \
+        \
+        do { \
+            cnt = 0; \
+            \
+            while (cnt < (size_t)elems.elem_cnt) { \
+                const size_t index = write_index + cnt; \
+                const size_t seq = atomic_load_explicit(&rb->cells[index & rb->mask].seq, memory_order_acquire); \
+                \
+                if (seq != index) { \
+                    break; \
+                } \
+                \
+                cnt++; \
+            } \
+            \
+            if (cnt == 0) { \
+                const size_t seq = atomic_load_explicit(&rb->cells[write_index & rb->mask].seq, memory_order_acquire); \
+                \
+                if ((intptr_t)(seq - write_index) < 0) { \
+                    return 0; \
+                } \
+                \
+                write_index = atomic_load_explicit(&rb->write_index, memory_order_relaxed); \
+                continue; \
+            } \
+        } while (cnt == 0 || !atomic_compare_exchange_weak_explicit(&rb->write_index, &write_index, write_index + cnt, memory_order_relaxed, memory_order_relaxed)); \
+        \
+        for (size_t i = 0; i < cnt; i++) { \
+            s_##name_snake##_mpmc_ring_buffer_cell* const cell = &rb->cells[(write_index + i) & rb->mask]; \
+            cell->elem = elems.buf_raw[i]; \
+            atomic_store_explicit(&cell->seq, write_index + i + 1, memory_order_release); \
+        } \
+        \
+        return (t_s32)cnt; \
+    } \
+    \
+    static inline t_s32 Pop##name_pascal##sFromMPMCRingBuffer(s_##name_snake##_mpmc_ring_buffer* const rb, const s_##name_snake##_array elems) { \
+        size_t read_index = atomic_load_explicit(&rb->read_index, memory_order_relaxed); \
+        size_t cnt; \
+        \
+        do { \
+            cnt = 0; \
+            \
+            while (cnt < (size_t)elems.elem_cnt) { \
+                const size_t index = read_index + cnt; \
+                const size_t seq = atomic_load_explicit(&rb->cells[index & rb->mask].seq, memory_order_acquire); \
+                \
+                if (seq != index + 1) { \
+                    break; \
+                } \
+                \
+                cnt++; \
+            } \
+            \
+            if (cnt == 0) { \
+                const size_t seq = atomic_load_explicit(&rb->cells[read_index & rb->mask].seq, memory_order_acquire); \
+                \
+                if ((intptr_t)(seq - (read_index + 1)) < 0) { \
+                    return 0; \
+                } \
+                \
+                read_index = atomic_load_explicit(&rb->read_index, memory_order_relaxed); \
+                continue; \
+            } \
+        } while (cnt == 0 || !atomic_compare_exchange_weak_explicit(&rb->read_index, &read_index, read_index + cnt, memory_order_relaxed, memory_order_relaxed)); \
+        \
+        for (size_t i = 0; i < cnt; i++) { \
+            s_##name_snake##_mpmc_ring_buffer_cell* const cell = &rb->cells[(read_index + i) & rb->mask]; \
+            elems.buf_raw[i] = cell->elem; \
+            atomic_store_explicit(&cell->seq, read_index + i + rb->mask + 1, memory_order_release); \
+        } \
+        \
+        return (t_s32)cnt; \
+    } \
+    \
+    static inline bool Push##name_pascal##ToMPMCRingBuffer(s_##name_snake##_mpmc_ring_buffer* const rb, const type elem) { \
+        return Push##name_pascal##sToMPMCRingBuffer(rb, (s_##name_snake##_array_view){.buf_raw = &elem, .elem_cnt = 1}) == 1; \
+    } \
+    \
+    static inline bool Pop##name_pascal##FromMPMCRingBuffer(s_##name_snake##_mpmc_ring_buffer* const rb, type* const elem) { \
+        return Pop##name_pascal##sFromMPMCRingBuffer(rb, (s_##name_snake##_array){.buf_raw = elem, .elem_cnt = 1}) == 1; \
+    }
+
+#endif
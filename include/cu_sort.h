@@ -0,0 +1,62 @@
+#ifndef CU_SORT_H
+#define CU_SORT_H
+
+#include "cu_mem.h"
+
+// All sorts are ascending and stable. Scratch memory is taken from the temporary memory arena and rewound before returning.
+// Arrays of up to SORT_NETWORK_LEN elements go through a branchless sorting network, larger ones through an LSD radix sort.
+
+#define SORT_NETWORK_LEN 16
+
+bool SortU32s(const s_u32_array array, s_mem_arena* const temp_mem_arena);
+bool SortS32s(const s_s32_array array, s_mem_arena* const temp_mem_arena);
+bool SortR32s(const s_r32_array array, s_mem_arena* const temp_mem_arena); // NaNs end up at either end depending on their sign bit.
+
+// Fills the indices array with the order in which the keys would be sorted.
+bool SortIndicesByKeys(const s_s32_array indices, const s_u32_array_view keys, s_mem_arena* const temp_mem_arena);
+
+// Reorders an array of elements of any type by their corresponding keys.
+bool SortElemsByKeys(void* const elems, const size_t elem_size, const s_u32_array_view keys, s_mem_arena* const temp_mem_arena);
+
+// Map a key to an unsigned integer which sorts in the same order.
+static inline t_u32 SortKeyFromS32(const t_s32 key) {
+    return (t_u32)key ^ 0x80000000u;
+}
+
+static inline t_u32 SortKeyFromR32(const t_r32 key) {
+    t_u32 bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
+
+static inline t_r32 R32FromSortKey(const t_u32 key) {
+    const t_u32 bits = key & 0x80000000u ? key & 0x7FFFFFFFu : ~key;
+
+    t_r32 val;
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+// Generates a function which sorts an array of the given type by a t_u32 key derived from each element, e.g. using SortKeyFromR32 on one of its fields.
+#define DEF_ARRAY_SORT_BY_KEY(type, name_snake, name_pascal, key_name_pascal, key_func) \
+    static inline bool Sort##name_pascal##sBy##key_name_pascal(const s_##name_snake##_array array, s_mem_arena* const temp_mem_arena) { \
+        const size_t temp_mem_arena_offs_init = temp_mem_arena->offs; \
+        \
+        const s_u32_array keys = PushU32ArrayToMemArena(temp_mem_arena, array.elem_cnt); \
+        \
+        if (!keys.buf_raw) { \
+            return false; \
+        } \
+        \
+        for (t_s32 i = 0; i < array.elem_cnt; i++) { \
+            *U32Elem(keys, i) = key_func(name_pascal##Elem(array, i)); \
+        } \
+        \
+        const bool success = SortElemsByKeys(array.buf_raw, sizeof(type), U32ArrayView(keys), temp_mem_arena); \
+        \
+        RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init); \
+        \
+        return success; \
+    }
+
+#endif
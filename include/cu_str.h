@@ -0,0 +1,40 @@
+#ifndef CU_STR_H
+#define CU_STR_H
+
+#include "cu_mem.h"
+
+// Scanning functions work over the full element count of the view, so a terminating byte counts as a character like any other.
+// Index-returning functions return -1 if nothing was found.
+
+t_s32 IndexOfChar(const s_char_array_view str, const char c);
+t_s32 LastIndexOfChar(const s_char_array_view str, const char c);
+t_s32 IndexOfAnyChar(const s_char_array_view str, const s_char_array_view set); // Sets of up to 16 characters are matched with SIMD, larger ones through a lookup table.
+t_s32 CountChar(const s_char_array_view str, const char c);
+
+static inline bool AreStrViewsEqual(const s_char_array_view a, const s_char_array_view b) {
+    return a.elem_cnt == b.elem_cnt && (a.elem_cnt == 0 || memcmp(a.buf_raw, b.buf_raw, a.elem_cnt) == 0);
+}
+
+// Drops the terminating byte if there is one, e.g. for text from LoadFileContentsAsStr.
+static inline s_char_array_view StrViewUnterminated(const s_char_array_view str) {
+    if (str.elem_cnt > 0 && !str.buf_raw[str.elem_cnt - 1]) {
+        return CharArrayViewSlice(str, 0, str.elem_cnt - 1);
+    }
+
+    return str;
+}
+
+// Slices the token before the next delimiter off of the front of the remaining string, without copying. Returns false once nothing remains.
+// Every delimiter separates two tokens, so "a,b," gives "a", "b" and "", and an empty string gives a single empty token.
+bool SplitStrNext(s_char_array_view* const remaining, const char delim, s_char_array_view* const token);
+
+// As above, but also handles "\r\n" line endings. A line ending at the very end doesn't give an extra empty line.
+bool SplitStrNextLine(s_char_array_view* const remaining, s_char_array_view* const line);
+
+// The whole view has to be consumed for parsing to succeed.
+bool ParseS64(const s_char_array_view str, t_s64* const val);
+bool ParseS32(const s_char_array_view str, t_s32* const val);
+bool ParseR64(const s_char_array_view str, t_r64* const val);
+bool ParseR32(const s_char_array_view str, t_r32* const val);
+
+#endif
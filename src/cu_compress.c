@@ -0,0 +1,376 @@
+#include "cu_compress.h"
+
+#include "cu_io.h"
+
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5 // The block format requires the last bytes to always be literals.
+#define LZ_MATCH_FIND_LIMIT 12 // No match may start closer to the end than this.
+#define LZ_MAX_OFFS 65535
+#define LZ_HASH_LOG 16
+
+static inline t_u32 ReadU32(const t_u8* const bytes) {
+    t_u32 val;
+    memcpy(&val, bytes, sizeof(val));
+    return val;
+}
+
+static inline t_u64 ReadU64(const t_u8* const bytes) {
+    t_u64 val;
+    memcpy(&val, bytes, sizeof(val));
+    return val;
+}
+
+static inline t_u32 LZHash(const t_u32 seq) {
+    return (seq * 2654435761u) >> (32 - LZ_HASH_LOG);
+}
+
+static inline t_u8* WriteLZLen(t_u8* dest, size_t len) {
+    while (len >= 255) {
+        *dest++ = 255;
+        len -= 255;
+    }
+
+    *dest++ = (t_u8)len;
+
+    return dest;
+}
+
+size_t LZCompressBound(const size_t src_size) {
+    return sizeof(s_lz_frame_header) + src_size + (src_size / 255) + 16;
+}
+
+// Returns the compressed size.
+static size_t CompressLZBlock(const t_u8* const src, const size_t src_size, t_u8* const dest, t_u32* const table) {
+    t_u8* op = dest;
+    size_t anchor = 0;
+
+    if (src_size > LZ_MATCH_FIND_LIMIT) {
+        const size_t match_find_end = src_size - LZ_MATCH_FIND_LIMIT;
+        const size_t match_ext_end = src_size - LZ_LAST_LITERALS;
+
+        size_t ip = 0;
+
+        while (ip < match_find_end) {
+            const t_u32 seq = ReadU32(src + ip);
+            const t_u32 hash = LZHash(seq);
+            const size_t cand = table[hash];
+            table[hash] = (t_u32)ip;
+
+            if (cand >= ip || ip - cand > LZ_MAX_OFFS || ReadU32(src + cand) != seq) {
+                // Skipping ahead faster the longer it's been since the last match, so incompressible data gets through quickly.
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            size_t match_len = LZ_MIN_MATCH;
+
+            while (ip + match_len + 8 <= match_ext_end && ReadU64(src + cand + match_len) == ReadU64(src + ip + match_len)) {
+                match_len += 8;
+            }
+
+            while (ip + match_len < match_ext_end && src[cand + match_len] == src[ip + match_len]) {
+                match_len++;
+            }
+
+            const size_t lit_len = ip - anchor;
+            t_u8* const token = op++;
+
+            *token = (t_u8)((lit_len >= 15 ? 15 : lit_len) << 4);
+
+            if (lit_len >= 15) {
+                op = WriteLZLen(op, lit_len - 15);
+            }
+
+            memcpy(op, src + anchor, lit_len);
+            op += lit_len;
+
+            const size_t offs = ip - cand;
+            *op++ = (t_u8)offs;
+            *op++ = (t_u8)(offs >> 8);
+
+            const size_t match_len_extra = match_len - LZ_MIN_MATCH;
+            *token |= (t_u8)(match_len_extra >= 15 ? 15 : match_len_extra);
+
+            if (match_len_extra >= 15) {
+                op = WriteLZLen(op, match_len_extra - 15);
+            }
+
+            ip += match_len;
+            anchor = ip;
+        }
+    }
+
+    const size_t lit_len = src_size - anchor;
+    *op++ = (t_u8)((lit_len >= 15 ? 15 : lit_len) << 4);
+
+    if (lit_len >= 15) {
+        op = WriteLZLen(op, lit_len - 15);
+    }
+
+    memcpy(op, src + anchor, lit_len);
+    op += lit_len;
+
+    return op - dest;
+}
+
+static bool ReadLZLen(const t_u8** const ip, const t_u8* const src_end, size_t* const len) {
+    t_u8 byte;
+
+    do {
+        if (*ip >= src_end) {
+            return false;
+        }
+
+        byte = *(*ip)++;
+        *len += byte;
+    } while (byte == 255);
+
+    return true;
+}
+
+static bool DecompressLZBlock(const t_u8* const src, const size_t src_size, t_u8* const dest, const size_t dest_size) {
+    const t_u8* ip = src;
+    const t_u8* const src_end = src + src_size;
+
+    t_u8* op = dest;
+    t_u8* const dest_end = dest + dest_size;
+
+    while (ip < src_end) {
+        const t_u8 token = *ip++;
+
+        size_t lit_len = token >> 4;
+
+        if (lit_len == 15 && !ReadLZLen(&ip, src_end, &lit_len)) {
+            return false;
+        }
+
+        if (lit_len > (size_t)(src_end - ip) || lit_len > (size_t)(dest_end - op)) {
+            return false;
+        }
+
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+
+        if (ip == src_end) {
+            break;
+        }
+
+        if (src_end - ip < 2) {
+            return false;
+        }
+
+        const size_t offs = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+
+        if (offs == 0 || offs > (size_t)(op - dest)) {
+            return false;
+        }
+
+        size_t match_len = token & 15;
+
+        if (match_len == 15 && !ReadLZLen(&ip, src_end, &match_len)) {
+            return false;
+        }
+
+        match_len += LZ_MIN_MATCH;
+
+        if (match_len > (size_t)(dest_end - op)) {
+            return false;
+        }
+
+        const t_u8* match = op - offs;
+
+        // Matches may overlap their own output (e.g. for runs), in which case bytes have to be copied one at a time, or in chunks no larger than the offset.
+        // Away from the end of the output, chunks are allowed to run past the match since the following sequences overwrite those bytes anyway.
+        if (offs >= 8 && (size_t)(dest_end - op) >= match_len + 8) {
+            t_u8* const match_end = op + match_len;
+
+            do {
+                memcpy(op, match, 8);
+                op += 8;
+                match += 8;
+            } while (op < match_end);
+
+            op = match_end;
+            continue;
+        }
+
+        if (offs >= 8) {
+            while (match_len >= 8) {
+                memcpy(op, match, 8);
+                op += 8;
+                match += 8;
+                match_len -= 8;
+            }
+        }
+
+        while (match_len > 0) {
+            *op++ = *match++;
+            match_len--;
+        }
+    }
+
+    return op == dest_end;
+}
+
+// Writes the frame header and block, returning the total size.
+static size_t CompressLZFrame(const s_u8_array_view src, t_u8* const dest, t_u32* const table) {
+    const size_t compressed_size = CompressLZBlock(src.buf_raw, src.elem_cnt, dest + sizeof(s_lz_frame_header), table);
+
+    const s_lz_frame_header header = {
+        .magic = LZ_FRAME_MAGIC,
+        .uncompressed_size = src.elem_cnt,
+        .compressed_size = compressed_size,
+        .checksum = HashBytes64(src.buf_raw, src.elem_cnt, 0)
+    };
+
+    memcpy(dest, &header, sizeof(header));
+
+    return sizeof(header) + compressed_size;
+}
+
+// Frames have to fit in a byte array, whose element count is 32-bit, for them to be decompressed again.
+static bool IsLZSrcSizeSupported(const size_t src_size) {
+    if (LZCompressBound(src_size) > INT32_MAX) {
+        LOG_ERROR("Data of %zu bytes is too large to be compressed into a single frame!", src_size);
+        return false;
+    }
+
+    return true;
+}
+
+// Pushes the hash table and a worst-case sized frame buffer.
+static bool PushLZCompressionMem(s_mem_arena* const temp_mem_arena, const size_t src_size, t_u32** const table, t_u8** const frame) {
+    *table = PushToMemArena(temp_mem_arena, sizeof(t_u32) << LZ_HASH_LOG, ALIGN_OF(t_u32));
+    *frame = *table ? PushToMemArena(temp_mem_arena, LZCompressBound(src_size), ALIGN_OF(s_lz_frame_header)) : NULL;
+    return *frame;
+}
+
+s_u8_array CompressLZ(const s_u8_array_view src, s_mem_arena* const mem_arena, s_mem_arena* const temp_mem_arena) {
+    assert(mem_arena != temp_mem_arena);
+
+    if (!IsLZSrcSizeSupported(src.elem_cnt)) {
+        return (s_u8_array){0};
+    }
+
+    const size_t temp_mem_arena_offs_init = temp_mem_arena->offs;
+
+    // Compressing into temporary memory first, so that only the exact compressed size ends up in the arena.
+    t_u32* table;
+    t_u8* frame_temp;
+
+    if (!PushLZCompressionMem(temp_mem_arena, src.elem_cnt, &table, &frame_temp)) {
+        RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+        return (s_u8_array){0};
+    }
+
+    const size_t frame_size = CompressLZFrame(src, frame_temp, table);
+
+    const s_u8_array frame = PushU8ArrayToMemArena(mem_arena, (t_s32)frame_size);
+
+    if (frame.buf_raw) {
+        memcpy(frame.buf_raw, frame_temp, frame_size);
+    }
+
+    RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+
+    return frame;
+}
+
+s_u8_array DecompressLZ(const s_u8_array_view frame, s_mem_arena* const mem_arena, const bool include_terminating_byte) {
+    s_lz_frame_header header;
+
+    if ((size_t)frame.elem_cnt < sizeof(header)) {
+        LOG_ERROR("Compressed data is too small to hold a frame header!");
+        return (s_u8_array){0};
+    }
+
+    memcpy(&header, frame.buf_raw, sizeof(header));
+
+    if (header.magic != LZ_FRAME_MAGIC || header.compressed_size != frame.elem_cnt - sizeof(header) || header.uncompressed_size >= INT32_MAX) {
+        LOG_ERROR("Compressed data has an invalid frame header!");
+        return (s_u8_array){0};
+    }
+
+    const size_t mem_arena_offs_init = mem_arena->offs;
+
+    const t_s32 uncompressed_size = (t_s32)header.uncompressed_size;
+    const s_u8_array contents = PushU8ArrayToMemArena(mem_arena, include_terminating_byte ? uncompressed_size + 1 : uncompressed_size);
+
+    if (!contents.buf_raw) {
+        return (s_u8_array){0};
+    }
+
+    if (!DecompressLZBlock(frame.buf_raw + sizeof(header), header.compressed_size, contents.buf_raw, uncompressed_size)) {
+        LOG_ERROR("Compressed data is malformed!");
+        RewindMemArena(mem_arena, mem_arena_offs_init);
+        return (s_u8_array){0};
+    }
+
+    if (HashBytes64(contents.buf_raw, uncompressed_size, 0) != header.checksum) {
+        LOG_ERROR("Decompressed data failed its checksum!");
+        RewindMemArena(mem_arena, mem_arena_offs_init);
+        return (s_u8_array){0};
+    }
+
+    return contents;
+}
+
+bool SaveFileCompressed(const s_char_array_view file_path, const s_u8_array_view contents, s_mem_arena* const temp_mem_arena) {
+    assert(IsStrTerminated(file_path));
+
+    if (!IsLZSrcSizeSupported(contents.elem_cnt)) {
+        return false;
+    }
+
+    const size_t temp_mem_arena_offs_init = temp_mem_arena->offs;
+
+    t_u32* table;
+    t_u8* frame;
+
+    if (!PushLZCompressionMem(temp_mem_arena, contents.elem_cnt, &table, &frame)) {
+        LOG_ERROR("Failed to reserve memory for compressing the contents of \"%s\"!", file_path.buf_raw);
+        RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+        return false;
+    }
+
+    const size_t frame_size = CompressLZFrame(contents, frame, table);
+
+    FILE* const fs = fopen(file_path.buf_raw, "wb");
+    bool success = false;
+
+    if (fs) {
+        success = fwrite(frame, 1, frame_size, fs) == frame_size;
+        success = fclose(fs) == 0 && success;
+    }
+
+    if (!success) {
+        LOG_ERROR("Failed to write compressed contents to \"%s\"!", file_path.buf_raw);
+    }
+
+    RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+
+    return success;
+}
+
+s_u8_array LoadFileCompressed(const s_char_array_view file_path, s_mem_arena* const mem_arena, s_mem_arena* const temp_mem_arena, const bool include_terminating_byte) {
+    const size_t temp_mem_arena_offs_init = temp_mem_arena->offs;
+
+    const s_u8_array frame = LoadFileContents(file_path, temp_mem_arena, false);
+
+    if (!frame.buf_raw) {
+        RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+        return (s_u8_array){0};
+    }
+
+    const s_u8_array contents = DecompressLZ(U8ArrayView(frame), mem_arena, include_terminating_byte);
+
+    if (!contents.buf_raw) {
+        LOG_ERROR("Failed to decompress the contents of \"%s\"!", file_path.buf_raw);
+    }
+
+    RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+
+    return contents;
+}
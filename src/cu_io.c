@@ -1,20 +1,45 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
 #include "cu_io.h"
 
+#include "cu_str.h"
+
+#ifdef _WIN32
 #include <windows.h>
+#include <sys/stat.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/syscall.h>
+#endif
 
 bool DoesFilenameHaveExt(const s_char_array_view filename, const s_char_array_view ext) {
     assert(IsStrTerminated(filename));
     assert(IsStrTerminated(ext));
 
-    const char* const ext_actual = strrchr(filename.buf_raw, '.');
+    const s_char_array_view filename_unterminated = CharArrayViewSlice(filename, 0, IndexOfChar(filename, '\0'));
+    const t_s32 dot_index = LastIndexOfChar(filename_unterminated, '.');
 
-    if (!ext_actual) {
+    if (dot_index == -1) {
         return false;
     }
 
-    return strcmp(ext.buf_raw, ext_actual) == 0;
+    const s_char_array_view ext_actual = CharArrayViewSlice(filename_unterminated, dot_index, filename_unterminated.elem_cnt);
+    return AreStrViewsEqual(CharArrayViewSlice(ext, 0, IndexOfChar(ext, '\0')), ext_actual);
 }
 
+#ifdef _WIN32
 bool LoadDirFilenames(s_filename_buf_array* const filename_bufs, s_mem_arena* const mem_arena, const s_char_array_view dir_param) {
     assert(IS_ZERO(*filename_bufs));
     assert(IsStrTerminated(dir_param));
@@ -48,6 +73,853 @@ bool LoadDirFilenames(s_filename_buf_array* const filename_bufs, s_mem_arena* co
 
     return true;
 }
+#else
+bool LoadDirFilenames(s_filename_buf_array* const filename_bufs, s_mem_arena* const mem_arena, const s_char_array_view dir_param) {
+    assert(IS_ZERO(*filename_bufs));
+    assert(IsStrTerminated(dir_param));
+
+    filename_bufs->buf_raw = (t_filename_buf*)(mem_arena->buf + AlignForward(mem_arena->offs, ALIGN_OF(t_filename_buf)));
+
+    DIR* const dir = opendir(dir_param.buf_raw);
+
+    if (!dir) {
+        return false;
+    }
+
+    const struct dirent* entry;
+
+    while ((entry = readdir(dir))) {
+        t_filename_buf* const filename = PushToMemArena(mem_arena, sizeof(t_filename_buf), ALIGN_OF(t_filename_buf));
+
+        if (!filename) {
+            closedir(dir);
+            return false;
+        }
+
+        memcpy(*filename, entry->d_name, strnlen(entry->d_name, sizeof(*filename) - 1));
+
+        filename_bufs->elem_cnt++;
+    }
+
+    closedir(dir);
+
+    return true;
+}
+#endif
+
+// MSVC only supports C11 atomics in C behind an experimental flag, so the shared counters of the walker go through the Interlocked functions there instead.
+#ifdef _WIN32
+typedef volatile LONG64 t_dir_walk_counter;
+
+static inline t_s64 DirWalkCounterFetchAdd(t_dir_walk_counter* const counter, const t_s64 val) {
+    return InterlockedExchangeAdd64(counter, val);
+}
+
+static inline t_s64 DirWalkCounterLoad(t_dir_walk_counter* const counter) {
+    return InterlockedCompareExchange64(counter, 0, 0);
+}
+#else
+typedef atomic_llong t_dir_walk_counter;
+
+static inline t_s64 DirWalkCounterFetchAdd(t_dir_walk_counter* const counter, const t_s64 val) {
+    return atomic_fetch_add(counter, val);
+}
+
+static inline t_s64 DirWalkCounterLoad(t_dir_walk_counter* const counter) {
+    return atomic_load(counter);
+}
+#endif
+
+#define DIR_WALK_CHUNK_SIZE KILOBYTES(64)
+
+// The free space of the temporary memory arena, which contexts claim chunks of through a shared cursor so that a single large subtree can use up as much of it as it needs.
+typedef struct {
+    t_u8* buf;
+    size_t size;
+    t_dir_walk_counter offs;
+} s_dir_walk_mem;
+
+static void* ClaimDirWalkMem(s_dir_walk_mem* const mem, const size_t size) {
+    const size_t size_aligned = AlignForward(size, 16);
+    const size_t offs = (size_t)DirWalkCounterFetchAdd(&mem->offs, (t_s64)size_aligned);
+
+    if (offs + size_aligned > mem->size) {
+        return NULL;
+    }
+
+    return mem->buf + offs;
+}
+
+typedef struct s_dir_walk_chunk {
+    struct s_dir_walk_chunk* next;
+    size_t used; // Includes the header.
+} s_dir_walk_chunk;
+
+// Entries are stored with their names directly after them.
+typedef struct {
+    s_dir_entry entry;
+    t_s32 name_len;
+} s_dir_walk_record;
+
+#define DIR_WALK_CHUNK_HEADER_SIZE AlignForward(sizeof(s_dir_walk_chunk), ALIGN_OF(s_dir_walk_record))
+
+static inline size_t DirWalkRecordSize(const t_s32 name_len) {
+    return AlignForward(sizeof(s_dir_walk_record) + name_len + 1, ALIGN_OF(s_dir_walk_record));
+}
+
+static inline const char* DirWalkRecordName(const s_dir_walk_record* const record) {
+    return (const char*)(record + 1);
+}
+
+typedef struct {
+    const char* name;
+    t_s32 index;
+} s_dir_walk_root_subdir;
+
+typedef struct {
+    s_dir_walk_mem* mem;
+    s_dir_walk_chunk* first_chunk;
+    s_dir_walk_chunk* last_chunk;
+    t_s32 entry_cnt;
+    size_t name_size;
+
+    const s_dir_walk_options* options;
+    bool failed;
+
+#ifdef _WIN32
+    const char* root_path;
+#else
+    int root_fd;
+#endif
+
+    const s_dir_walk_root_subdir* root_subdirs;
+    t_s32 root_subdir_cnt;
+    t_dir_walk_counter* next_root_subdir_index;
+
+#ifdef __linux__
+    t_u8 read_buf[KILOBYTES(32)];
+#endif
+} s_dir_walk_ctx;
+
+typedef struct {
+    s_dir_walk_chunk* chunk;
+    size_t offs;
+} s_dir_walk_cursor;
+
+// Where the next pushed record will go, or just before it if a new chunk ends up being needed.
+static inline s_dir_walk_cursor DirWalkEndCursor(const s_dir_walk_ctx* const ctx) {
+    return (s_dir_walk_cursor){.chunk = ctx->last_chunk, .offs = ctx->last_chunk ? ctx->last_chunk->used : 0};
+}
+
+// Only chunks before the last are ever moved on from, and their sizes don't change once the next chunk has been claimed.
+static s_dir_walk_record* DirWalkCursorRecord(const s_dir_walk_ctx* const ctx, s_dir_walk_cursor* const cursor) {
+    if (!cursor->chunk) {
+        cursor->chunk = ctx->first_chunk;
+        cursor->offs = DIR_WALK_CHUNK_HEADER_SIZE;
+    } else if (cursor->offs >= cursor->chunk->used) {
+        cursor->chunk = cursor->chunk->next;
+        cursor->offs = DIR_WALK_CHUNK_HEADER_SIZE;
+    }
+
+    return (s_dir_walk_record*)((t_u8*)cursor->chunk + cursor->offs);
+}
+
+static inline void AdvanceDirWalkCursor(const s_dir_walk_ctx* const ctx, s_dir_walk_cursor* const cursor) {
+    cursor->offs += DirWalkRecordSize(DirWalkCursorRecord(ctx, cursor)->name_len);
+}
+
+static bool PassesExtFilter(const char* const name, const size_t name_len, const s_char_array_view ext) {
+    if (!ext.buf_raw) {
+        return true;
+    }
+
+    const size_t ext_len = strlen(ext.buf_raw);
+    return name_len >= ext_len && memcmp(name + name_len - ext_len, ext.buf_raw, ext_len) == 0;
+}
+
+static bool PushWalkEntry(s_dir_walk_ctx* const ctx, const char* const name, const size_t name_len, const t_s32 parent_index, const e_dir_entry_type type, const t_u64 size) {
+    if (type == ek_dir_entry_type_file && !PassesExtFilter(name, name_len, ctx->options->ext)) {
+        return true;
+    }
+
+    const size_t record_size = DirWalkRecordSize((t_s32)name_len);
+    assert(DIR_WALK_CHUNK_HEADER_SIZE + record_size <= DIR_WALK_CHUNK_SIZE);
+
+    if (!ctx->last_chunk || ctx->last_chunk->used + record_size > DIR_WALK_CHUNK_SIZE) {
+        s_dir_walk_chunk* const chunk = ClaimDirWalkMem(ctx->mem, DIR_WALK_CHUNK_SIZE);
+
+        if (!chunk) {
+            LOG_ERROR("Ran out of the %zu bytes of temporary memory available for walking directories!", ctx->mem->size);
+            ctx->failed = true;
+            return false;
+        }
+
+        *chunk = (s_dir_walk_chunk){.used = DIR_WALK_CHUNK_HEADER_SIZE};
+
+        if (ctx->last_chunk) {
+            ctx->last_chunk->next = chunk;
+        } else {
+            ctx->first_chunk = chunk;
+        }
+
+        ctx->last_chunk = chunk;
+    }
+
+    s_dir_walk_record* const record = (s_dir_walk_record*)((t_u8*)ctx->last_chunk + ctx->last_chunk->used);
+
+    *record = (s_dir_walk_record){
+        .entry = {
+            .parent_index = parent_index,
+            .type = type,
+            .size = size
+        },
+        .name_len = (t_s32)name_len
+    };
+
+    memcpy(record + 1, name, name_len + 1);
+
+    ctx->last_chunk->used += record_size;
+    ctx->entry_cnt++;
+    ctx->name_size += name_len + 1;
+
+    return true;
+}
+
+#if defined(_WIN32)
+static bool WalkDirLevel(s_dir_walk_ctx* const ctx, const char* const dir_path, const t_s32 parent_index, const bool recurse) {
+    char search_path[MAX_PATH];
+
+    if (snprintf(search_path, MAX_PATH, "%s\\*", dir_path) >= MAX_PATH) {
+        LOG_WARNING("Skipping directory \"%s\" as its path is too long!", dir_path);
+        return true;
+    }
+
+    WIN32_FIND_DATAA find_data;
+    const HANDLE find = FindFirstFileExA(search_path, FindExInfoBasic, &find_data, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+
+    if (find == INVALID_HANDLE_VALUE) {
+        LOG_WARNING("Skipping directory \"%s\" as it could not be opened!", dir_path);
+        return true;
+    }
+
+    const t_s32 beg = ctx->entry_cnt;
+    const s_dir_walk_cursor level_cursor = DirWalkEndCursor(ctx);
+
+    do {
+        const char* const name = find_data.cFileName;
+
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+
+        e_dir_entry_type type = ek_dir_entry_type_file;
+
+        if (find_data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+            type = ek_dir_entry_type_other;
+        } else if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            type = ek_dir_entry_type_dir;
+        }
+
+        const t_u64 size = type == ek_dir_entry_type_file && ctx->options->load_sizes ? ((t_u64)find_data.nFileSizeHigh << 32) | find_data.nFileSizeLow : 0;
+
+        if (!PushWalkEntry(ctx, name, strlen(name), parent_index, type, size)) {
+            FindClose(find);
+            return false;
+        }
+    } while (FindNextFileA(find, &find_data));
+
+    FindClose(find);
+
+    if (recurse) {
+        const t_s32 end = ctx->entry_cnt;
+
+        s_dir_walk_cursor cursor = level_cursor;
+
+        for (t_s32 i = beg; i < end; i++, AdvanceDirWalkCursor(ctx, &cursor)) {
+            const s_dir_walk_record* const record = DirWalkCursorRecord(ctx, &cursor);
+
+            if (record->entry.type != ek_dir_entry_type_dir) {
+                continue;
+            }
+
+            char sub_path[MAX_PATH];
+
+            if (snprintf(sub_path, MAX_PATH, "%s\\%s", dir_path, DirWalkRecordName(record)) >= MAX_PATH) {
+                LOG_WARNING("Skipping subdirectory \"%s\" of \"%s\" as its path is too long!", DirWalkRecordName(record), dir_path);
+                continue;
+            }
+
+            if (!WalkDirLevel(ctx, sub_path, i, true)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+#else
+static bool WalkDirLevel(s_dir_walk_ctx* const ctx, const int dir_fd, const t_s32 parent_index, const bool recurse) {
+    const t_s32 beg = ctx->entry_cnt;
+    const s_dir_walk_cursor level_cursor = DirWalkEndCursor(ctx);
+
+#ifdef __linux__
+    // Using getdents64 directly so that a single syscall returns a whole batch of entries along with their types.
+    while (true) {
+        const long read_size = syscall(SYS_getdents64, dir_fd, ctx->read_buf, sizeof(ctx->read_buf));
+
+        if (read_size < 0) {
+            LOG_ERROR("Failed to read directory entries!");
+            ctx->failed = true;
+            return false;
+        }
+
+        if (read_size == 0) {
+            break;
+        }
+
+        for (long read_offs = 0; read_offs < read_size;) {
+            const t_u8* const record = ctx->read_buf + read_offs;
+
+            // Matching the layout of struct linux_dirent64, which glibc doesn't expose.
+            t_u16 record_len;
+            memcpy(&record_len, record + 16, sizeof(record_len));
+
+            const t_u8 d_type = record[18];
+            const char* const name = (const char*)(record + 19);
+
+            read_offs += record_len;
+#else
+    const int dup_fd = dup(dir_fd);
+    DIR* const dir = dup_fd >= 0 ? fdopendir(dup_fd) : NULL;
+
+    if (!dir) {
+        LOG_ERROR("Failed to read directory entries!");
+        ctx->failed = true;
+        return false;
+    }
+
+    {
+        const struct dirent* dirent;
+
+        while ((dirent = readdir(dir))) {
+            const t_u8 d_type = dirent->d_type;
+            const char* const name = dirent->d_name;
+#endif
+
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+
+            e_dir_entry_type type;
+            bool need_stat = false;
+
+            switch (d_type) {
+                case DT_REG:
+                    type = ek_dir_entry_type_file;
+                    need_stat = ctx->options->load_sizes;
+                    break;
+
+                case DT_DIR:
+                    type = ek_dir_entry_type_dir;
+                    break;
+
+                case DT_UNKNOWN:
+                    // Some filesystems don't report types, so we have to ask.
+                    type = ek_dir_entry_type_other;
+                    need_stat = true;
+                    break;
+
+                default:
+                    type = ek_dir_entry_type_other;
+                    break;
+            }
+
+            t_u64 size = 0;
+
+            if (need_stat) {
+                struct stat st;
+
+                if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                    if (S_ISREG(st.st_mode)) {
+                        type = ek_dir_entry_type_file;
+                        size = ctx->options->load_sizes ? (t_u64)st.st_size : 0;
+                    } else if (S_ISDIR(st.st_mode)) {
+                        type = ek_dir_entry_type_dir;
+                    }
+                }
+            }
+
+            if (!PushWalkEntry(ctx, name, strlen(name), parent_index, type, size)) {
+#ifndef __linux__
+                closedir(dir);
+#endif
+                return false;
+            }
+        }
+    }
+
+#ifndef __linux__
+    closedir(dir);
+#endif
+
+    if (recurse) {
+        const t_s32 end = ctx->entry_cnt;
+
+        s_dir_walk_cursor cursor = level_cursor;
+
+        for (t_s32 i = beg; i < end; i++, AdvanceDirWalkCursor(ctx, &cursor)) {
+            const s_dir_walk_record* const record = DirWalkCursorRecord(ctx, &cursor);
+
+            if (record->entry.type != ek_dir_entry_type_dir) {
+                continue;
+            }
+
+            const int sub_fd = openat(dir_fd, DirWalkRecordName(record), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+            if (sub_fd < 0) {
+                LOG_WARNING("Skipping subdirectory \"%s\" as it could not be opened!", DirWalkRecordName(record));
+                continue;
+            }
+
+            const bool success = WalkDirLevel(ctx, sub_fd, i, true);
+            close(sub_fd);
+
+            if (!success) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+#endif
+
+// Parent indices below -1 refer to an entry of the root context (-2 being the first). They get resolved when the contexts are merged.
+static inline t_s32 RootParentIndex(const t_s32 root_entry_index) {
+    return -2 - root_entry_index;
+}
+
+static void WalkRootSubdirs(s_dir_walk_ctx* const ctx) {
+    while (!ctx->failed) {
+        const t_s32 i = (t_s32)DirWalkCounterFetchAdd(ctx->next_root_subdir_index, 1);
+
+        if (i >= ctx->root_subdir_cnt) {
+            break;
+        }
+
+        const char* const name = ctx->root_subdirs[i].name;
+        const t_s32 parent_index = RootParentIndex(ctx->root_subdirs[i].index);
+
+#ifdef _WIN32
+        char sub_path[MAX_PATH];
+
+        if (snprintf(sub_path, MAX_PATH, "%s\\%s", ctx->root_path, name) >= MAX_PATH) {
+            LOG_WARNING("Skipping subdirectory \"%s\" as its path is too long!", name);
+            continue;
+        }
+
+        WalkDirLevel(ctx, sub_path, parent_index, true);
+#else
+        const int sub_fd = openat(ctx->root_fd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+        if (sub_fd < 0) {
+            LOG_WARNING("Skipping subdirectory \"%s\" as it could not be opened!", name);
+            continue;
+        }
+
+        WalkDirLevel(ctx, sub_fd, parent_index, true);
+        close(sub_fd);
+#endif
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI WalkRootSubdirsThread(void* const ctx) {
+    WalkRootSubdirs(ctx);
+    return 0;
+}
+#else
+static void* WalkRootSubdirsThread(void* const ctx) {
+    WalkRootSubdirs(ctx);
+    return NULL;
+}
+#endif
+
+bool WalkDir(s_dir_tree* const tree, s_mem_arena* const mem_arena, s_mem_arena* const temp_mem_arena, const s_char_array_view dir_path, const s_dir_walk_options options) {
+    assert(IS_ZERO(*tree));
+    assert(IsStrTerminated(dir_path));
+    assert(!options.ext.buf_raw || IsStrTerminated(options.ext));
+    assert(options.thread_cnt >= 0 && options.thread_cnt <= DIR_WALK_THREAD_LIMIT);
+
+    const t_s32 worker_cnt = options.recursive ? (options.thread_cnt > 1 ? options.thread_cnt : 1) : 0;
+    const t_s32 ctx_cnt = 1 + worker_cnt; // The first context is for the entries directly inside the walked directory.
+
+    const size_t temp_mem_arena_offs_init = temp_mem_arena->offs;
+
+    s_dir_walk_ctx* const ctxs = PushToMemArena(temp_mem_arena, sizeof(*ctxs) * ctx_cnt, ALIGN_OF(s_dir_walk_ctx));
+
+    if (!ctxs) {
+        return false;
+    }
+
+    // Rather than pushing, the remaining free space is claimed from directly so that only the region actually used needs to be zeroed afterwards.
+    s_dir_walk_mem mem;
+
+    {
+        const size_t free_offs = AlignForward(temp_mem_arena->offs, 16);
+
+        mem = (s_dir_walk_mem){
+            .buf = temp_mem_arena->buf + free_offs,
+            .size = free_offs < temp_mem_arena->size ? temp_mem_arena->size - free_offs : 0
+        };
+
+        for (t_s32 i = 0; i < ctx_cnt; i++) {
+            ctxs[i].mem = &mem;
+            ctxs[i].options = &options;
+        }
+    }
+
+    bool success = false;
+
+#ifdef _WIN32
+    const char* const root_path = dir_path.buf_raw;
+#else
+    const int root_fd = open(dir_path.buf_raw, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    if (root_fd < 0) {
+        LOG_ERROR("Failed to open directory \"%s\"!", dir_path.buf_raw);
+        goto cleanup;
+    }
+#endif
+
+#ifdef _WIN32
+    if (!WalkDirLevel(&ctxs[0], root_path, -1, false)) {
+#else
+    if (!WalkDirLevel(&ctxs[0], root_fd, -1, false)) {
+#endif
+        goto cleanup;
+    }
+
+    {
+        // Gather the subdirectories of the root for the workers to claim.
+        s_dir_walk_root_subdir* root_subdirs = NULL;
+        t_s32 root_subdir_cnt = 0;
+
+        if (worker_cnt > 0 && ctxs[0].entry_cnt > 0) {
+            root_subdirs = ClaimDirWalkMem(&mem, sizeof(*root_subdirs) * ctxs[0].entry_cnt);
+
+            if (!root_subdirs) {
+                LOG_ERROR("Ran out of the %zu bytes of temporary memory available for walking directories!", mem.size);
+                goto cleanup;
+            }
+
+            s_dir_walk_cursor cursor = {0};
+
+            for (t_s32 i = 0; i < ctxs[0].entry_cnt; i++, AdvanceDirWalkCursor(&ctxs[0], &cursor)) {
+                const s_dir_walk_record* const record = DirWalkCursorRecord(&ctxs[0], &cursor);
+
+                if (record->entry.type == ek_dir_entry_type_dir) {
+                    root_subdirs[root_subdir_cnt] = (s_dir_walk_root_subdir){.name = DirWalkRecordName(record), .index = i};
+                    root_subdir_cnt++;
+                }
+            }
+        }
+
+        t_dir_walk_counter next_root_subdir_index = 0;
+
+        for (t_s32 i = 1; i < ctx_cnt; i++) {
+#ifdef _WIN32
+            ctxs[i].root_path = root_path;
+#else
+            ctxs[i].root_fd = root_fd;
+#endif
+            ctxs[i].root_subdirs = root_subdirs;
+            ctxs[i].root_subdir_cnt = root_subdir_cnt;
+            ctxs[i].next_root_subdir_index = &next_root_subdir_index;
+        }
+
+        // The calling thread takes on the first worker context itself. If a thread fails to spawn, the others just pick up its share.
+#ifdef _WIN32
+        HANDLE threads[DIR_WALK_THREAD_LIMIT];
+#else
+        pthread_t threads[DIR_WALK_THREAD_LIMIT];
+#endif
+        bool threads_spawned[DIR_WALK_THREAD_LIMIT] = {0};
+
+        for (t_s32 i = 2; i < ctx_cnt; i++) {
+#ifdef _WIN32
+            threads[i - 2] = CreateThread(NULL, 0, WalkRootSubdirsThread, &ctxs[i], 0, NULL);
+            threads_spawned[i - 2] = threads[i - 2] != NULL;
+#else
+            threads_spawned[i - 2] = pthread_create(&threads[i - 2], NULL, WalkRootSubdirsThread, &ctxs[i]) == 0;
+#endif
+        }
+
+        if (worker_cnt > 0) {
+            WalkRootSubdirs(&ctxs[1]);
+        }
+
+        for (t_s32 i = 2; i < ctx_cnt; i++) {
+            if (threads_spawned[i - 2]) {
+#ifdef _WIN32
+                WaitForSingleObject(threads[i - 2], INFINITE);
+                CloseHandle(threads[i - 2]);
+#else
+                pthread_join(threads[i - 2], NULL);
+#endif
+            }
+        }
+    }
+
+    // Merge the contexts into the output arena.
+    {
+        t_s32 total_entry_cnt = 0;
+        size_t total_name_size = 0;
+
+        for (t_s32 i = 0; i < ctx_cnt; i++) {
+            if (ctxs[i].failed) {
+                goto cleanup;
+            }
+
+            total_entry_cnt += ctxs[i].entry_cnt;
+            total_name_size += ctxs[i].name_size;
+        }
+
+        tree->entries = PushDirEntryArrayToMemArena(mem_arena, total_entry_cnt);
+        tree->names = PushCharArrayToMemArena(mem_arena, (t_s32)total_name_size);
+
+        if (!tree->entries.buf_raw || !tree->names.buf_raw) {
+            ZERO_OUT(*tree);
+            goto cleanup;
+        }
+
+        t_s32 entry_base = 0;
+        t_s32 name_base = 0;
+
+        // Records are stored in the order of their local indices, so each context can just be read through.
+        for (t_s32 i = 0; i < ctx_cnt; i++) {
+            s_dir_walk_cursor cursor = {0};
+
+            for (t_s32 j = 0; j < ctxs[i].entry_cnt; j++, AdvanceDirWalkCursor(&ctxs[i], &cursor)) {
+                const s_dir_walk_record* const record = DirWalkCursorRecord(&ctxs[i], &cursor);
+
+                s_dir_entry entry = record->entry;
+
+                entry.name_offs = name_base;
+
+                if (entry.parent_index >= 0) {
+                    entry.parent_index += entry_base;
+                } else if (entry.parent_index < -1) {
+                    entry.parent_index = -2 - entry.parent_index;
+                }
+
+                *DirEntryElem(tree->entries, entry_base + j) = entry;
+
+                memcpy(tree->names.buf_raw + name_base, DirWalkRecordName(record), record->name_len + 1);
+                name_base += record->name_len + 1;
+            }
+
+            entry_base += ctxs[i].entry_cnt;
+        }
+    }
+
+    success = true;
+
+cleanup:
+#ifndef _WIN32
+    if (root_fd >= 0) {
+        close(root_fd);
+    }
+#endif
+
+    {
+        const size_t mem_offs = (size_t)DirWalkCounterLoad(&mem.offs);
+        const size_t mem_used = mem_offs < mem.size ? mem_offs : mem.size;
+
+        if (mem_used > 0) {
+            ZeroOut(mem.buf, mem_used);
+        }
+    }
+
+    RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+
+    return success;
+}
+
+static bool WriteDirEntryPath(char* const buf, const size_t buf_size, size_t* const len, const s_dir_tree* const tree, const t_s32 entry_index) {
+    const s_dir_entry* const entry = DirEntryElem(tree->entries, entry_index);
+
+    if (entry->parent_index >= 0) {
+        if (!WriteDirEntryPath(buf, buf_size, len, tree, entry->parent_index)) {
+            return false;
+        }
+
+        if (*len + 1 >= buf_size) {
+            return false;
+        }
+
+        buf[(*len)++] = '/';
+    }
+
+    const char* const name = CharElem(tree->names, entry->name_offs);
+    const size_t name_len = strlen(name);
+
+    if (*len + name_len >= buf_size) {
+        return false;
+    }
+
+    memcpy(buf + *len, name, name_len + 1);
+    *len += name_len;
+
+    return true;
+}
+
+bool LoadDirEntryPath(char* const buf, const size_t buf_size, const s_dir_tree* const tree, const t_s32 entry_index) {
+    assert(buf && buf_size > 0);
+
+    size_t len = 0;
+    return WriteDirEntryPath(buf, buf_size, &len, tree, entry_index);
+}
+
+bool SaveMemArenaSnapshot(const s_mem_arena* const arena, const s_char_array_view file_path, const t_u32 version) {
+    assert(IsStrTerminated(file_path));
+
+    FILE* const fs = fopen(file_path.buf_raw, "wb");
+
+    if (!fs) {
+        LOG_ERROR("Failed to open \"%s\" for writing!", file_path.buf_raw);
+        return false;
+    }
+
+    t_u8 header_bytes[MEM_ARENA_SNAPSHOT_HEADER_SIZE] = {0};
+
+    const s_mem_arena_snapshot_header header = {
+        .magic = MEM_ARENA_SNAPSHOT_MAGIC,
+        .version = version,
+        .data_size = arena->offs,
+        .checksum = HashBytes64(arena->buf, arena->offs, 0)
+    };
+
+    memcpy(header_bytes, &header, sizeof(header));
+
+    const bool success = fwrite(header_bytes, 1, sizeof(header_bytes), fs) == sizeof(header_bytes)
+        && fwrite(arena->buf, 1, arena->offs, fs) == arena->offs;
+
+    if (fclose(fs) != 0 || !success) {
+        LOG_ERROR("Failed to write memory arena snapshot to \"%s\"!", file_path.buf_raw);
+        return false;
+    }
+
+    return true;
+}
+
+bool MapMemArenaSnapshot(s_mem_arena_snapshot* const snapshot, const s_char_array_view file_path, const t_u32 version, const bool verify_checksum) {
+    assert(IS_ZERO(*snapshot));
+    assert(IsStrTerminated(file_path));
+
+#ifdef _WIN32
+    const HANDLE file = CreateFileA(file_path.buf_raw, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to open \"%s\"!", file_path.buf_raw);
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < MEM_ARENA_SNAPSHOT_HEADER_SIZE) {
+        LOG_ERROR("Memory arena snapshot \"%s\" is too small!", file_path.buf_raw);
+        CloseHandle(file);
+        return false;
+    }
+
+    const HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* const map = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+
+    // The view keeps the mapping alive by itself.
+    if (mapping) {
+        CloseHandle(mapping);
+    }
+
+    CloseHandle(file);
+
+    if (!map) {
+        LOG_ERROR("Failed to map \"%s\"!", file_path.buf_raw);
+        return false;
+    }
+
+    const size_t map_size = (size_t)file_size.QuadPart;
+#else
+    const int fd = open(file_path.buf_raw, O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        LOG_ERROR("Failed to open \"%s\"!", file_path.buf_raw);
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || st.st_size < MEM_ARENA_SNAPSHOT_HEADER_SIZE) {
+        LOG_ERROR("Memory arena snapshot \"%s\" is too small!", file_path.buf_raw);
+        close(fd);
+        return false;
+    }
+
+    const size_t map_size = (size_t)st.st_size;
+    void* const map = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Failed to map \"%s\"!", file_path.buf_raw);
+        return false;
+    }
+#endif
+
+    snapshot->map = map;
+    snapshot->map_size = map_size;
+
+    s_mem_arena_snapshot_header header;
+    memcpy(&header, map, sizeof(header));
+
+    if (header.magic != MEM_ARENA_SNAPSHOT_MAGIC || header.data_size != map_size - MEM_ARENA_SNAPSHOT_HEADER_SIZE) {
+        LOG_ERROR("\"%s\" is not a valid memory arena snapshot!", file_path.buf_raw);
+        UnmapMemArenaSnapshot(snapshot);
+        return false;
+    }
+
+    if (header.version != version) {
+        LOG_ERROR("Memory arena snapshot \"%s\" has version %u, expected %u!", file_path.buf_raw, header.version, version);
+        UnmapMemArenaSnapshot(snapshot);
+        return false;
+    }
+
+    const t_u8* const data = (const t_u8*)map + MEM_ARENA_SNAPSHOT_HEADER_SIZE;
+
+    // Verifying touches every page, so callers after the fastest startup may want to skip it.
+    if (verify_checksum && HashBytes64(data, header.data_size, 0) != header.checksum) {
+        LOG_ERROR("Memory arena snapshot \"%s\" failed its checksum!", file_path.buf_raw);
+        UnmapMemArenaSnapshot(snapshot);
+        return false;
+    }
+
+    snapshot->data = data;
+    snapshot->data_size = header.data_size;
+
+    return true;
+}
+
+void UnmapMemArenaSnapshot(s_mem_arena_snapshot* const snapshot) {
+    assert(snapshot->map);
+
+#ifdef _WIN32
+    UnmapViewOfFile(snapshot->map);
+#else
+    munmap(snapshot->map, snapshot->map_size);
+#endif
+
+    ZERO_OUT(*snapshot);
+}
 
 s_u8_array LoadFileContents(const s_char_array_view file_path, s_mem_arena* const mem_arena, const bool include_terminating_byte) {
     FILE* const fs = fopen(file_path.buf_raw, "rb");
@@ -75,3 +947,294 @@ s_u8_array LoadFileContents(const s_char_array_view file_path, s_mem_arena* cons
 
     return contents;
 }
+
+typedef struct {
+    t_u64 mtime_ns;
+    t_u64 size;
+} s_file_stamp;
+
+static bool LoadFileStamp(const char* const file_path, s_file_stamp* const stamp) {
+#ifdef _WIN32
+    struct _stat64 st;
+
+    if (_stat64(file_path, &st) != 0) {
+        return false;
+    }
+
+    stamp->mtime_ns = (t_u64)st.st_mtime * 1000000000;
+#else
+    struct stat st;
+
+    if (stat(file_path, &st) != 0) {
+        return false;
+    }
+
+#if defined(__APPLE__)
+    stamp->mtime_ns = ((t_u64)st.st_mtimespec.tv_sec * 1000000000) + st.st_mtimespec.tv_nsec;
+#else
+    stamp->mtime_ns = ((t_u64)st.st_mtim.tv_sec * 1000000000) + st.st_mtim.tv_nsec;
+#endif
+#endif
+
+    stamp->size = (t_u64)st.st_size;
+
+    return true;
+}
+
+bool InitFileCache(s_file_cache* const cache, s_mem_arena* const mem_arena, const t_s32 cap, const bool watch) {
+    assert(IS_ZERO(*cache));
+    assert(IsPowerOfTwo(cap));
+
+    cache->entries = PushToMemArena(mem_arena, sizeof(*cache->entries) * cap, ALIGN_OF(s_file_cache_entry));
+
+    if (!cache->entries) {
+        return false;
+    }
+
+    cache->mem_arena = mem_arena;
+    cache->cap = cap;
+    cache->inotify_fd = -1;
+
+    if (watch) {
+#ifdef __linux__
+        cache->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (cache->inotify_fd < 0) {
+            LOG_WARNING("Failed to initialise file watching, falling back to checking modification times.");
+        }
+#else
+        LOG_WARNING("File watching is unsupported on this platform, falling back to checking modification times.");
+#endif
+    }
+
+    return true;
+}
+
+void CleanFileCache(s_file_cache* const cache) {
+#ifdef __linux__
+    if (cache->inotify_fd >= 0) {
+        close(cache->inotify_fd);
+    }
+#endif
+
+    ZERO_OUT(*cache);
+}
+
+#ifdef __linux__
+#define FILE_CACHE_WATCH_MASK (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF)
+
+// Marks the entries of any files which have had events since the last call as stale.
+// The same file reached through different paths shares a watch descriptor, so the events of each read are gathered up and matched against all entries in a single pass.
+static void PollFileCacheWatches(s_file_cache* const cache) {
+    _Alignas(struct inotify_event) char buf[4096];
+
+    // Each key is the watch descriptor shifted up by one, with the low bit set if the watch is gone.
+    t_u32 keys[sizeof(buf) / sizeof(struct inotify_event)];
+
+    while (true) {
+        const ssize_t read_size = read(cache->inotify_fd, buf, sizeof(buf));
+
+        if (read_size <= 0) {
+            break;
+        }
+
+        t_s32 key_cnt = 0;
+        bool overflowed = false;
+
+        for (ssize_t offs = 0; offs < read_size;) {
+            const struct inotify_event* const event = (const struct inotify_event*)(buf + offs);
+            offs += sizeof(*event) + event->len;
+
+            // Events were dropped, so there's no telling which files changed.
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed = true;
+                continue;
+            }
+
+            const t_u32 key = ((t_u32)event->wd << 1) | ((event->mask & IN_IGNORED) ? 1 : 0);
+
+            // Insertion sort, as there are usually only a handful of events.
+            t_s32 i = key_cnt;
+
+            for (; i > 0 && keys[i - 1] > key; i--) {
+                keys[i] = keys[i - 1];
+            }
+
+            keys[i] = key;
+            key_cnt++;
+        }
+
+        for (t_s32 i = 0; i < cache->cap; i++) {
+            s_file_cache_entry* const entry = &cache->entries[i];
+
+            if (!entry->path.buf_raw || entry->watch_desc < 0) {
+                continue;
+            }
+
+            if (overflowed) {
+                entry->stale = true;
+            }
+
+            const t_u32 wd_key = (t_u32)entry->watch_desc << 1;
+
+            t_s32 lo = 0;
+            t_s32 hi = key_cnt;
+
+            while (lo < hi) {
+                const t_s32 mid = lo + ((hi - lo) / 2);
+
+                if (keys[mid] < wd_key) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+
+            if (lo == key_cnt || (keys[lo] >> 1) != (t_u32)entry->watch_desc) {
+                continue;
+            }
+
+            entry->stale = true;
+
+            // The watch is gone if the file was replaced or deleted, so it needs adding again on the next load. Ignored keys sort last for their descriptor.
+            while (lo + 1 < key_cnt && (keys[lo + 1] >> 1) == (t_u32)entry->watch_desc) {
+                lo++;
+            }
+
+            if (keys[lo] & 1) {
+                entry->watch_desc = -1;
+            }
+        }
+    }
+}
+#endif
+
+static bool ReloadFileCacheEntry(s_file_cache* const cache, s_file_cache_entry* const entry, const s_file_stamp stamp) {
+    const char* const file_path = entry->path.buf_raw;
+
+    FILE* const fs = fopen(file_path, "rb");
+
+    if (!fs) {
+        LOG_ERROR("Failed to open \"%s\"!", file_path);
+        return false;
+    }
+
+    fseek(fs, 0, SEEK_END);
+    const size_t file_size = ftell(fs);
+    fseek(fs, 0, SEEK_SET);
+
+    // Reading into a separate buffer if the contents are unchanged would be wasteful, so the old buffer gets reused whenever it's big enough.
+    t_u8* buf = (t_u8*)entry->contents.buf_raw;
+
+    if (!buf || file_size + 1 > entry->contents_cap) {
+        buf = PushToMemArena(cache->mem_arena, file_size + 1, 16);
+
+        if (!buf) {
+            LOG_ERROR("Failed to reserve memory for the contents of file \"%s\"!", file_path);
+            fclose(fs);
+            return false;
+        }
+
+        entry->contents_cap = file_size + 1;
+    }
+
+    const size_t read_size = fread(buf, 1, file_size, fs);
+    fclose(fs);
+
+    if (read_size < file_size) {
+        LOG_ERROR("Failed to read the contents of \"%s\"!", file_path);
+        return false;
+    }
+
+    buf[file_size] = 0;
+
+    const t_u64 hash = HashBytes64(buf, file_size, 0);
+
+    if (!entry->contents.buf_raw || hash != entry->hash || file_size != (size_t)entry->contents.elem_cnt) {
+        entry->version++;
+    }
+
+    entry->contents = (s_u8_array_view){.buf_raw = buf, .elem_cnt = (t_s32)file_size};
+    entry->hash = hash;
+    entry->mtime_ns = stamp.mtime_ns;
+    entry->size = stamp.size;
+    entry->stale = false;
+
+    return true;
+}
+
+const s_file_cache_entry* LoadFileCached(s_file_cache* const cache, const s_char_array_view file_path) {
+    assert(IsStrTerminated(file_path));
+
+    const size_t path_len = strlen(file_path.buf_raw);
+    const t_u64 path_hash = HashBytes64(file_path.buf_raw, path_len, 0);
+
+    s_file_cache_entry* entry = NULL;
+
+    for (t_s32 i = 0; i < cache->cap; i++) {
+        s_file_cache_entry* const slot = &cache->entries[(path_hash + i) & (cache->cap - 1)];
+
+        if (!slot->path.buf_raw) {
+            entry = slot;
+            break;
+        }
+
+        if (slot->path_hash == path_hash && strcmp(slot->path.buf_raw, file_path.buf_raw) == 0) {
+            entry = slot;
+            break;
+        }
+    }
+
+    if (!entry) {
+        LOG_ERROR("File cache is full, could not load \"%s\"!", file_path.buf_raw);
+        return NULL;
+    }
+
+    if (!entry->path.buf_raw) {
+        char* const path = PushToMemArena(cache->mem_arena, path_len + 1, 1);
+
+        if (!path) {
+            return NULL;
+        }
+
+        memcpy(path, file_path.buf_raw, path_len + 1);
+
+        entry->path = (s_char_array_view){.buf_raw = path, .elem_cnt = (t_s32)path_len + 1};
+        entry->path_hash = path_hash;
+        entry->watch_desc = -1;
+        entry->stale = true;
+
+        cache->entry_cnt++;
+    }
+
+#ifdef __linux__
+    if (cache->inotify_fd >= 0) {
+        PollFileCacheWatches(cache);
+
+        if (entry->watch_desc >= 0 && !entry->stale) {
+            return entry;
+        }
+
+        // Adding the watch before reading so that no change in between gets missed.
+        entry->watch_desc = inotify_add_watch(cache->inotify_fd, entry->path.buf_raw, FILE_CACHE_WATCH_MASK);
+    }
+#endif
+
+    s_file_stamp stamp;
+
+    if (!LoadFileStamp(entry->path.buf_raw, &stamp)) {
+        LOG_ERROR("Failed to query \"%s\"!", entry->path.buf_raw);
+        return NULL;
+    }
+
+    if (!entry->stale && stamp.mtime_ns == entry->mtime_ns && stamp.size == entry->size) {
+        return entry;
+    }
+
+    if (!ReloadFileCacheEntry(cache, entry, stamp)) {
+        entry->stale = true;
+        return NULL;
+    }
+
+    return entry;
+}
@@ -1,5 +1,9 @@
 #include <cu_math.h>
 
+#ifdef SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
 s_rect GenSpanningRect(const s_rect_array_view rects) {
     s_rect_edges span = {
         RectElemView(rects, 0)->x,
@@ -35,3 +39,181 @@ s_rect GenSpanningRect(const s_rect_array_view rects) {
         span.bottom - span.top
     };
 }
+
+void SeedRNG(s_rng* const rng, const t_u64 seed) {
+    // Expanding the seed with SplitMix64 guarantees a non-zero state with well-mixed bits, even for seeds like 0 or 1.
+    t_u64 x = seed;
+
+    for (t_s32 i = 0; i < 4; i += 2) {
+        x += 0x9E3779B97F4A7C15ULL;
+
+        t_u64 z = x;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+
+        rng->state[i] = (t_u32)z;
+        rng->state[i + 1] = (t_u32)(z >> 32);
+    }
+
+    rng->lanes_split = false;
+}
+
+static void JumpRNGByPoly(s_rng* const rng, const t_u32 poly[4]) {
+    t_u32 s[4] = {0};
+
+    for (t_s32 i = 0; i < 4; i++) {
+        for (t_s32 b = 0; b < 32; b++) {
+            if (poly[i] & (1u << b)) {
+                s[0] ^= rng->state[0];
+                s[1] ^= rng->state[1];
+                s[2] ^= rng->state[2];
+                s[3] ^= rng->state[3];
+            }
+
+            AdvanceRNG(rng);
+        }
+    }
+
+    memcpy(rng->state, s, sizeof(s));
+
+    // The lanes belonged to the old position.
+    rng->lanes_split = false;
+}
+
+void JumpRNG(s_rng* const rng) {
+    static const t_u32 jump[4] = {0x8764000B, 0xF542D2D3, 0x6FA035C3, 0x77F2DB5B};
+    JumpRNGByPoly(rng, jump);
+}
+
+void LongJumpRNG(s_rng* const rng) {
+    static const t_u32 long_jump[4] = {0xB523952E, 0x0B6F099F, 0xCCF5A0EF, 0x1C580662};
+    JumpRNGByPoly(rng, long_jump);
+}
+
+#define RNG_BATCH_MIN 64
+
+// Lane N starts where the main state would be after N + 1 jumps, so the main state keeps the first 2^64 values to itself and a long jump covers all of them.
+static void SplitRNGLanes(s_rng* const rng) {
+    if (rng->lanes_split) {
+        return;
+    }
+
+    s_rng jumped = *rng;
+
+    for (t_s32 i = 0; i < RNG_LANE_CNT; i++) {
+        JumpRNG(&jumped);
+
+        for (t_s32 j = 0; j < 4; j++) {
+            rng->lane_state[j][i] = jumped.state[j];
+        }
+    }
+
+    rng->lanes_split = true;
+}
+
+#ifdef SIMD_SSE2
+// Writes RNG_LANE_CNT floats in [0, 1) scaled by range, offset by min and clamped to limit per group.
+static void FillR32sRandLanes(t_r32* const dest, const t_s32 group_cnt, t_u32 (* const lane_state)[RNG_LANE_CNT], const __m128 min, const __m128 range, const __m128 limit) {
+    __m128i s0 = _mm_loadu_si128((const __m128i*)lane_state[0]);
+    __m128i s1 = _mm_loadu_si128((const __m128i*)lane_state[1]);
+    __m128i s2 = _mm_loadu_si128((const __m128i*)lane_state[2]);
+    __m128i s3 = _mm_loadu_si128((const __m128i*)lane_state[3]);
+
+    const __m128 scale = _mm_set1_ps(1.0f / 16777216.0f);
+
+    for (t_s32 i = 0; i < group_cnt; i++) {
+        const __m128i result = _mm_add_epi32(s0, s3);
+
+        const __m128i t = _mm_slli_epi32(s1, 9);
+        s2 = _mm_xor_si128(s2, s0);
+        s3 = _mm_xor_si128(s3, s1);
+        s1 = _mm_xor_si128(s1, s2);
+        s0 = _mm_xor_si128(s0, s3);
+        s2 = _mm_xor_si128(s2, t);
+        s3 = _mm_or_si128(_mm_slli_epi32(s3, 11), _mm_srli_epi32(s3, 21));
+
+        const __m128 unit = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(result, 8)), scale);
+        _mm_storeu_ps(dest + (i * RNG_LANE_CNT), _mm_min_ps(_mm_add_ps(min, _mm_mul_ps(unit, range)), limit));
+    }
+
+    _mm_storeu_si128((__m128i*)lane_state[0], s0);
+    _mm_storeu_si128((__m128i*)lane_state[1], s1);
+    _mm_storeu_si128((__m128i*)lane_state[2], s2);
+    _mm_storeu_si128((__m128i*)lane_state[3], s3);
+}
+
+static void FillR32sRandBatch(t_r32* const dest, const t_s32 group_cnt, t_u32 (* const lane_state)[RNG_LANE_CNT], const t_r32 mins[RNG_LANE_CNT], const t_r32 ranges[RNG_LANE_CNT], const t_r32 limits[RNG_LANE_CNT]) {
+    FillR32sRandLanes(dest, group_cnt, lane_state, _mm_loadu_ps(mins), _mm_loadu_ps(ranges), _mm_loadu_ps(limits));
+}
+#else
+static void FillR32sRandBatch(t_r32* const dest, const t_s32 group_cnt, t_u32 (* const lane_state)[RNG_LANE_CNT], const t_r32 mins[RNG_LANE_CNT], const t_r32 ranges[RNG_LANE_CNT], const t_r32 limits[RNG_LANE_CNT]) {
+    // Laid out so that the compiler can vectorise across the lanes.
+    t_u32 (* const s)[RNG_LANE_CNT] = lane_state;
+
+    for (t_s32 i = 0; i < group_cnt; i++) {
+        for (t_s32 l = 0; l < RNG_LANE_CNT; l++) {
+            const t_u32 result = s[0][l] + s[3][l];
+            const t_u32 t = s[1][l] << 9;
+
+            s[2][l] ^= s[0][l];
+            s[3][l] ^= s[1][l];
+            s[1][l] ^= s[2][l];
+            s[0][l] ^= s[3][l];
+            s[2][l] ^= t;
+            s[3][l] = RotL32(s[3][l], 11);
+
+            const t_r32 val = mins[l] + ((result >> 8) * (1.0f / 16777216.0f) * ranges[l]);
+            dest[(i * RNG_LANE_CNT) + l] = val < limits[l] ? val : limits[l];
+        }
+    }
+}
+#endif
+
+void FillR32sRand(const s_r32_array array, s_rng* const rng, const t_r32 min, const t_r32 max) {
+    assert(min <= max);
+
+    t_s32 i = 0;
+
+    if (array.elem_cnt >= RNG_BATCH_MIN) {
+        SplitRNGLanes(rng);
+
+        const t_r32 mins[RNG_LANE_CNT] = {min, min, min, min};
+        const t_r32 ranges[RNG_LANE_CNT] = {max - min, max - min, max - min, max - min};
+        const t_r32 limit = RandR32RangeLimit(min, max);
+        const t_r32 limits[RNG_LANE_CNT] = {limit, limit, limit, limit};
+
+        const t_s32 group_cnt = array.elem_cnt / RNG_LANE_CNT;
+        FillR32sRandBatch(array.buf_raw, group_cnt, rng->lane_state, mins, ranges, limits);
+        i = group_cnt * RNG_LANE_CNT;
+    }
+
+    for (; i < array.elem_cnt; i++) {
+        *R32Elem(array, i) = RandR32InRange(rng, min, max);
+    }
+}
+
+void FillV2sRand(const s_v2_array array, s_rng* const rng, const s_v2 min, const s_v2 max) {
+    assert(min.x <= max.x && min.y <= max.y);
+    static_assert(sizeof(s_v2) == 2 * sizeof(t_r32), "Type size assumption broken!");
+
+    t_s32 i = 0;
+
+    if (array.elem_cnt >= RNG_BATCH_MIN) {
+        SplitRNGLanes(rng);
+
+        // Each group of lanes covers two vectors, alternating between x and y.
+        const t_r32 mins[RNG_LANE_CNT] = {min.x, min.y, min.x, min.y};
+        const t_r32 ranges[RNG_LANE_CNT] = {max.x - min.x, max.y - min.y, max.x - min.x, max.y - min.y};
+        const s_v2 limit = {RandR32RangeLimit(min.x, max.x), RandR32RangeLimit(min.y, max.y)};
+        const t_r32 limits[RNG_LANE_CNT] = {limit.x, limit.y, limit.x, limit.y};
+
+        const t_s32 group_cnt = array.elem_cnt / 2;
+        FillR32sRandBatch((t_r32*)array.buf_raw, group_cnt, rng->lane_state, mins, ranges, limits);
+        i = group_cnt * 2;
+    }
+
+    for (; i < array.elem_cnt; i++) {
+        *V2Elem(array, i) = RandV2InRange(rng, min, max);
+    }
+}
@@ -1,8 +1,20 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
 #include "cu_mem.h"
 
 #include <stdlib.h>
 #include "cu_io.h"
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 bool InitMemArena(s_mem_arena* const arena, const size_t size) {
     assert(IS_ZERO(*arena));
 
@@ -20,10 +32,229 @@ bool InitMemArena(s_mem_arena* const arena, const size_t size) {
     return true;
 }
 
+#if defined(__linux__)
+#define HUGE_PAGE_SIZE MEGABYTES(2)
+
+// Over-maps and trims so that transparent huge pages can back the whole region.
+static void* MapAligned(const size_t size, const size_t alignment) {
+    const size_t map_size = size + alignment;
+    t_u8* const map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    t_u8* const buf = (t_u8*)AlignForward((size_t)map, alignment);
+    const size_t head_size = buf - map;
+    const size_t tail_size = map_size - head_size - size;
+
+    if (head_size > 0) {
+        munmap(map, head_size);
+    }
+
+    if (tail_size > 0) {
+        munmap(buf + size, tail_size);
+    }
+
+    return buf;
+}
+
+#ifdef SYS_mbind
+#define NUMA_NODE_LIMIT 1024
+#define NUMA_MPOL_BIND 2
+#define NUMA_MPOL_INTERLEAVE 3
+
+// Going through the syscall directly rather than depending on libnuma.
+static bool ApplyNUMAPolicy(void* const buf, const size_t size, const s_mem_arena_options options) {
+    unsigned long node_mask[NUMA_NODE_LIMIT / SIZE_IN_BITS(unsigned long)] = {0};
+    const size_t node_mask_elem_bits = SIZE_IN_BITS(unsigned long);
+
+    if (options.numa_policy == ek_mem_arena_numa_policy_bind) {
+        if (options.numa_node < 0 || options.numa_node >= NUMA_NODE_LIMIT) {
+            return false;
+        }
+
+        node_mask[options.numa_node / node_mask_elem_bits] |= 1UL << (options.numa_node % node_mask_elem_bits);
+    } else {
+        // Reads ranges like "0-1,3".
+        FILE* const fs = fopen("/sys/devices/system/node/online", "r");
+
+        if (!fs) {
+            return false;
+        }
+
+        int beg;
+        int end;
+        int c = ',';
+
+        while (c == ',' && fscanf(fs, "%d", &beg) == 1) {
+            end = beg;
+            c = fgetc(fs);
+
+            if (c == '-') {
+                if (fscanf(fs, "%d", &end) != 1) {
+                    break;
+                }
+
+                c = fgetc(fs);
+            }
+
+            for (int n = beg; n <= end && n < NUMA_NODE_LIMIT; n++) {
+                node_mask[n / node_mask_elem_bits] |= 1UL << (n % node_mask_elem_bits);
+            }
+        }
+
+        fclose(fs);
+    }
+
+    const int mode = options.numa_policy == ek_mem_arena_numa_policy_bind ? NUMA_MPOL_BIND : NUMA_MPOL_INTERLEAVE;
+    return syscall(SYS_mbind, buf, size, mode, node_mask, NUMA_NODE_LIMIT + 1, 0) == 0;
+}
+#else
+static bool ApplyNUMAPolicy(void* const buf, const size_t size, const s_mem_arena_options options) {
+    return false;
+}
+#endif
+#endif
+
+#ifdef _WIN32
+// Large pages are only granted once the "Lock pages in memory" privilege is enabled in the process token, which in turn requires the account to hold it.
+static bool EnableLockMemoryPrivilege(void) {
+    HANDLE token;
+
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+        return false;
+    }
+
+    TOKEN_PRIVILEGES privileges = {.PrivilegeCount = 1};
+    privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+    bool success = LookupPrivilegeValueA(NULL, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid)
+        && AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL);
+
+    // This still succeeds without the privilege being assigned, only setting the last error.
+    success = success && GetLastError() != ERROR_NOT_ALL_ASSIGNED;
+
+    CloseHandle(token);
+
+    return success;
+}
+#endif
+
+bool InitMemArenaWithOptions(s_mem_arena* const arena, const size_t size, const s_mem_arena_options options) {
+    assert(IS_ZERO(*arena));
+    assert(size > 0);
+
+    if (options.huge_pages == ek_mem_arena_huge_pages_none && options.numa_policy == ek_mem_arena_numa_policy_default) {
+        return InitMemArena(arena, size);
+    }
+
+#if defined(__linux__)
+    void* buf = NULL;
+    size_t map_size = 0;
+
+    if (options.huge_pages == ek_mem_arena_huge_pages_explicit) {
+        map_size = AlignForward(size, HUGE_PAGE_SIZE);
+        buf = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if (buf == MAP_FAILED) {
+            LOG_WARNING("Explicit huge pages are unavailable for a memory arena of size %zu bytes, falling back to transparent huge pages.", size);
+            buf = NULL;
+        }
+    }
+
+    if (!buf) {
+        const size_t page_size = options.huge_pages == ek_mem_arena_huge_pages_none ? (size_t)sysconf(_SC_PAGESIZE) : HUGE_PAGE_SIZE;
+
+        map_size = AlignForward(size, page_size);
+        buf = MapAligned(map_size, page_size);
+
+        if (!buf) {
+            LOG_ERROR("Failed to initialise memory arena of size %zu bytes!", size);
+            return false;
+        }
+
+        if (options.huge_pages != ek_mem_arena_huge_pages_none && madvise(buf, map_size, MADV_HUGEPAGE) != 0) {
+            LOG_WARNING("Transparent huge pages are unavailable for a memory arena of size %zu bytes.", size);
+        }
+    }
+
+    // This has to happen before anything touches the pages. Fresh mappings are already zeroed, so nothing needs to.
+    if (options.numa_policy != ek_mem_arena_numa_policy_default && !ApplyNUMAPolicy(buf, map_size, options)) {
+        LOG_WARNING("Failed to apply NUMA policy to memory arena of size %zu bytes.", size);
+    }
+#elif defined(_WIN32)
+    const bool numa_bind = options.numa_policy == ek_mem_arena_numa_policy_bind;
+
+    if (options.numa_policy == ek_mem_arena_numa_policy_interleave) {
+        LOG_WARNING("NUMA interleaving is unsupported on this platform.");
+    }
+
+    void* buf = NULL;
+    size_t map_size = 0;
+
+    // Windows has no equivalent of transparent huge pages. Its large pages are always locked in physical memory, so they are only used when asked for explicitly.
+    if (options.huge_pages == ek_mem_arena_huge_pages_transparent) {
+        LOG_WARNING("Transparent huge pages are unsupported on this platform.");
+    }
+
+    if (options.huge_pages == ek_mem_arena_huge_pages_explicit) {
+        const size_t large_page_size = GetLargePageMinimum();
+
+        if (large_page_size == 0) {
+            LOG_WARNING("Large pages are unsupported on this system.");
+        } else if (!EnableLockMemoryPrivilege()) {
+            LOG_WARNING("Failed to enable the \"Lock pages in memory\" privilege needed for large pages, which has to be granted to the account.");
+        } else {
+            map_size = AlignForward(size, large_page_size);
+
+            const DWORD alloc_type = MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES;
+            buf = numa_bind ? VirtualAllocExNuma(GetCurrentProcess(), NULL, map_size, alloc_type, PAGE_READWRITE, options.numa_node) : VirtualAlloc(NULL, map_size, alloc_type, PAGE_READWRITE);
+
+            if (!buf) {
+                LOG_WARNING("Large pages are unavailable for a memory arena of size %zu bytes.", size);
+            }
+        }
+    }
+
+    if (!buf) {
+        map_size = size;
+
+        const DWORD alloc_type = MEM_RESERVE | MEM_COMMIT;
+        buf = numa_bind ? VirtualAllocExNuma(GetCurrentProcess(), NULL, map_size, alloc_type, PAGE_READWRITE, options.numa_node) : VirtualAlloc(NULL, map_size, alloc_type, PAGE_READWRITE);
+
+        if (!buf) {
+            LOG_ERROR("Failed to initialise memory arena of size %zu bytes!", size);
+            return false;
+        }
+    }
+#else
+    LOG_WARNING("Memory arena options are unsupported on this platform.");
+    return InitMemArena(arena, size);
+#endif
+
+#if defined(__linux__) || defined(_WIN32)
+    arena->buf = buf;
+    arena->size = size;
+    arena->map_size = map_size;
+
+    return true;
+#endif
+}
+
 void CleanMemArena(s_mem_arena* const arena) {
     assert(arena->buf);
 
-    free(arena->buf);
+    if (arena->map_size) {
+#if defined(_WIN32)
+        VirtualFree(arena->buf, 0, MEM_RELEASE);
+#elif defined(__linux__)
+        munmap(arena->buf, arena->map_size);
+#endif
+    } else {
+        free(arena->buf);
+    }
+
     ZERO_OUT(*arena);
 }
 
@@ -50,6 +281,100 @@ void RewindMemArena(s_mem_arena* const arena, const size_t rewind_offs) {
     }
 }
 
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline t_u64 RotL64(const t_u64 x, const int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline t_u64 ReadU64(const t_u8* const bytes) {
+    t_u64 val;
+    memcpy(&val, bytes, sizeof(val));
+    return val;
+}
+
+static inline t_u32 ReadU32(const t_u8* const bytes) {
+    t_u32 val;
+    memcpy(&val, bytes, sizeof(val));
+    return val;
+}
+
+static inline t_u64 XXH64Round(t_u64 acc, const t_u64 input) {
+    acc += input * XXH_PRIME64_2;
+    acc = RotL64(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static inline t_u64 XXH64MergeRound(t_u64 acc, const t_u64 val) {
+    acc ^= XXH64Round(0, val);
+    return (acc * XXH_PRIME64_1) + XXH_PRIME64_4;
+}
+
+t_u64 HashBytes64(const void* const data, const size_t size, const t_u64 seed) {
+    assert(data || size == 0);
+
+    const t_u8* bytes = data;
+    const t_u8* const end = bytes + size;
+
+    t_u64 hash;
+
+    if (size >= 32) {
+        // Four independent accumulators so that the multiplies can overlap.
+        t_u64 v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        t_u64 v2 = seed + XXH_PRIME64_2;
+        t_u64 v3 = seed;
+        t_u64 v4 = seed - XXH_PRIME64_1;
+
+        do {
+            v1 = XXH64Round(v1, ReadU64(bytes));
+            v2 = XXH64Round(v2, ReadU64(bytes + 8));
+            v3 = XXH64Round(v3, ReadU64(bytes + 16));
+            v4 = XXH64Round(v4, ReadU64(bytes + 24));
+            bytes += 32;
+        } while (end - bytes >= 32);
+
+        hash = RotL64(v1, 1) + RotL64(v2, 7) + RotL64(v3, 12) + RotL64(v4, 18);
+        hash = XXH64MergeRound(hash, v1);
+        hash = XXH64MergeRound(hash, v2);
+        hash = XXH64MergeRound(hash, v3);
+        hash = XXH64MergeRound(hash, v4);
+    } else {
+        hash = seed + XXH_PRIME64_5;
+    }
+
+    hash += size;
+
+    while (end - bytes >= 8) {
+        hash ^= XXH64Round(0, ReadU64(bytes));
+        hash = (RotL64(hash, 27) * XXH_PRIME64_1) + XXH_PRIME64_4;
+        bytes += 8;
+    }
+
+    if (end - bytes >= 4) {
+        hash ^= ReadU32(bytes) * XXH_PRIME64_1;
+        hash = (RotL64(hash, 23) * XXH_PRIME64_2) + XXH_PRIME64_3;
+        bytes += 4;
+    }
+
+    while (bytes < end) {
+        hash ^= *bytes * XXH_PRIME64_5;
+        hash = RotL64(hash, 11) * XXH_PRIME64_1;
+        bytes++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
 t_s32 IndexOfFirstUnsetBit(const s_bitset_view bitset) {
     for (t_s32 i = 0; i < (bitset.bit_cnt / 8); i++) {
         const t_u8 byte = *U8ElemView(bitset.bytes, i);
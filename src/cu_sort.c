@@ -0,0 +1,294 @@
+#include "cu_sort.h"
+
+static inline void CompareSwapU32s(t_u32* const a, t_u32* const b) {
+    const t_u32 lo = *a < *b ? *a : *b;
+    const t_u32 hi = *a < *b ? *b : *a;
+    *a = lo;
+    *b = hi;
+}
+
+static inline void CompareSwapU64s(t_u64* const a, t_u64* const b) {
+    const t_u64 lo = *a < *b ? *a : *b;
+    const t_u64 hi = *a < *b ? *b : *a;
+    *a = lo;
+    *b = hi;
+}
+
+// Batcher's odd-even merge sort over a fixed length. The comparator sequence doesn't depend on the data, so it fully unrolls into conditional moves.
+#define SORT_NETWORK(elems, compare_swap) \
+    for (t_s32 p = 1; p < SORT_NETWORK_LEN; p <<= 1) { \
+        for (t_s32 k = p; k >= 1; k >>= 1) { \
+            for (t_s32 j = k % p; j + k < SORT_NETWORK_LEN; j += 2 * k) { \
+                for (t_s32 i = 0; i < k && i + j + k < SORT_NETWORK_LEN; i++) { \
+                    if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) { \
+                        compare_swap(&(elems)[i + j], &(elems)[i + j + k]); \
+                    } \
+                } \
+            } \
+        } \
+    }
+
+static void NetworkSortU32s(t_u32* const elems, const t_s32 cnt) {
+    assert(cnt <= SORT_NETWORK_LEN);
+
+    t_u32 padded[SORT_NETWORK_LEN];
+    memcpy(padded, elems, sizeof(*elems) * cnt);
+
+    for (t_s32 i = cnt; i < SORT_NETWORK_LEN; i++) {
+        padded[i] = UINT32_MAX;
+    }
+
+    SORT_NETWORK(padded, CompareSwapU32s);
+
+    memcpy(elems, padded, sizeof(*elems) * cnt);
+}
+
+// Stability comes for free here since the low bits of each element are its original index.
+static void NetworkSortU64s(t_u64* const elems, const t_s32 cnt) {
+    assert(cnt <= SORT_NETWORK_LEN);
+
+    t_u64 padded[SORT_NETWORK_LEN];
+    memcpy(padded, elems, sizeof(*elems) * cnt);
+
+    for (t_s32 i = cnt; i < SORT_NETWORK_LEN; i++) {
+        padded[i] = UINT64_MAX;
+    }
+
+    SORT_NETWORK(padded, CompareSwapU64s);
+
+    memcpy(elems, padded, sizeof(*elems) * cnt);
+}
+
+static void RadixSortU32s(t_u32* const elems, t_u32* const scratch, const t_s32 cnt) {
+    // Building every histogram up front means only one extra read pass over the data.
+    t_u32 hists[4][256] = {0};
+
+    for (t_s32 i = 0; i < cnt; i++) {
+        const t_u32 elem = elems[i];
+        hists[0][elem & 0xFF]++;
+        hists[1][(elem >> 8) & 0xFF]++;
+        hists[2][(elem >> 16) & 0xFF]++;
+        hists[3][elem >> 24]++;
+    }
+
+    t_u32* src = elems;
+    t_u32* dest = scratch;
+
+    for (t_s32 b = 0; b < 4; b++) {
+        const t_s32 shift = b * 8;
+
+        // If every element shares this byte, the pass wouldn't change anything.
+        if (hists[b][(src[0] >> shift) & 0xFF] == (t_u32)cnt) {
+            continue;
+        }
+
+        t_u32 offs = 0;
+
+        for (t_s32 i = 0; i < 256; i++) {
+            const t_u32 bucket_cnt = hists[b][i];
+            hists[b][i] = offs;
+            offs += bucket_cnt;
+        }
+
+        for (t_s32 i = 0; i < cnt; i++) {
+            const t_u32 elem = src[i];
+            dest[hists[b][(elem >> shift) & 0xFF]++] = elem;
+        }
+
+        t_u32* const temp = src;
+        src = dest;
+        dest = temp;
+    }
+
+    if (src != elems) {
+        memcpy(elems, src, sizeof(*elems) * cnt);
+    }
+}
+
+// Only sorts on the upper 32 bits, which hold the key.
+static void RadixSortKeyIndexPairs(t_u64* const pairs, t_u64* const scratch, const t_s32 cnt) {
+    t_u32 hists[4][256] = {0};
+
+    for (t_s32 i = 0; i < cnt; i++) {
+        const t_u32 key = pairs[i] >> 32;
+        hists[0][key & 0xFF]++;
+        hists[1][(key >> 8) & 0xFF]++;
+        hists[2][(key >> 16) & 0xFF]++;
+        hists[3][key >> 24]++;
+    }
+
+    t_u64* src = pairs;
+    t_u64* dest = scratch;
+
+    for (t_s32 b = 0; b < 4; b++) {
+        const t_s32 shift = 32 + (b * 8);
+
+        if (hists[b][(src[0] >> shift) & 0xFF] == (t_u32)cnt) {
+            continue;
+        }
+
+        t_u32 offs = 0;
+
+        for (t_s32 i = 0; i < 256; i++) {
+            const t_u32 bucket_cnt = hists[b][i];
+            hists[b][i] = offs;
+            offs += bucket_cnt;
+        }
+
+        for (t_s32 i = 0; i < cnt; i++) {
+            const t_u64 pair = src[i];
+            dest[hists[b][(pair >> shift) & 0xFF]++] = pair;
+        }
+
+        t_u64* const temp = src;
+        src = dest;
+        dest = temp;
+    }
+
+    if (src != pairs) {
+        memcpy(pairs, src, sizeof(*pairs) * cnt);
+    }
+}
+
+bool SortU32s(const s_u32_array array, s_mem_arena* const temp_mem_arena) {
+    if (array.elem_cnt <= SORT_NETWORK_LEN) {
+        NetworkSortU32s(array.buf_raw, array.elem_cnt);
+        return true;
+    }
+
+    const size_t temp_mem_arena_offs_init = temp_mem_arena->offs;
+
+    const s_u32_array scratch = PushU32ArrayToMemArena(temp_mem_arena, array.elem_cnt);
+
+    if (!scratch.buf_raw) {
+        return false;
+    }
+
+    RadixSortU32s(array.buf_raw, scratch.buf_raw, array.elem_cnt);
+
+    RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+
+    return true;
+}
+
+bool SortS32s(const s_s32_array array, s_mem_arena* const temp_mem_arena) {
+    // Sorting the bits in place as unsigned keys, then mapping them back.
+    const s_u32_array keys = {.buf_raw = (t_u32*)array.buf_raw, .elem_cnt = array.elem_cnt};
+
+    for (t_s32 i = 0; i < keys.elem_cnt; i++) {
+        *U32Elem(keys, i) = SortKeyFromS32(*S32Elem(array, i));
+    }
+
+    const bool success = SortU32s(keys, temp_mem_arena);
+
+    for (t_s32 i = 0; i < keys.elem_cnt; i++) {
+        *U32Elem(keys, i) ^= 0x80000000u;
+    }
+
+    return success;
+}
+
+bool SortR32s(const s_r32_array array, s_mem_arena* const temp_mem_arena) {
+    // The keys go in a separate buffer rather than being written over the floats, which would break strict aliasing.
+    const size_t temp_mem_arena_offs_init = temp_mem_arena->offs;
+
+    const s_u32_array keys = PushU32ArrayToMemArena(temp_mem_arena, array.elem_cnt);
+
+    if (!keys.buf_raw) {
+        return false;
+    }
+
+    for (t_s32 i = 0; i < keys.elem_cnt; i++) {
+        *U32Elem(keys, i) = SortKeyFromR32(*R32Elem(array, i));
+    }
+
+    const bool success = SortU32s(keys, temp_mem_arena);
+
+    if (success) {
+        for (t_s32 i = 0; i < keys.elem_cnt; i++) {
+            *R32Elem(array, i) = R32FromSortKey(*U32Elem(keys, i));
+        }
+    }
+
+    RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+
+    return success;
+}
+
+static s_u64_array PushSortedKeyIndexPairs(const s_u32_array_view keys, s_mem_arena* const temp_mem_arena) {
+    const s_u64_array pairs = PushU64ArrayToMemArena(temp_mem_arena, keys.elem_cnt);
+
+    if (!pairs.buf_raw) {
+        return (s_u64_array){0};
+    }
+
+    for (t_s32 i = 0; i < keys.elem_cnt; i++) {
+        *U64Elem(pairs, i) = ((t_u64)*U32ElemView(keys, i) << 32) | (t_u32)i;
+    }
+
+    if (keys.elem_cnt <= SORT_NETWORK_LEN) {
+        NetworkSortU64s(pairs.buf_raw, pairs.elem_cnt);
+        return pairs;
+    }
+
+    const s_u64_array scratch = PushU64ArrayToMemArena(temp_mem_arena, keys.elem_cnt);
+
+    if (!scratch.buf_raw) {
+        return (s_u64_array){0};
+    }
+
+    RadixSortKeyIndexPairs(pairs.buf_raw, scratch.buf_raw, pairs.elem_cnt);
+
+    return pairs;
+}
+
+bool SortIndicesByKeys(const s_s32_array indices, const s_u32_array_view keys, s_mem_arena* const temp_mem_arena) {
+    assert(indices.elem_cnt == keys.elem_cnt);
+
+    const size_t temp_mem_arena_offs_init = temp_mem_arena->offs;
+
+    const s_u64_array pairs = PushSortedKeyIndexPairs(keys, temp_mem_arena);
+
+    if (!pairs.buf_raw && keys.elem_cnt > 0) {
+        RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+        return false;
+    }
+
+    for (t_s32 i = 0; i < indices.elem_cnt; i++) {
+        *S32Elem(indices, i) = (t_s32)(*U64Elem(pairs, i) & 0xFFFFFFFF);
+    }
+
+    RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+
+    return true;
+}
+
+bool SortElemsByKeys(void* const elems, const size_t elem_size, const s_u32_array_view keys, s_mem_arena* const temp_mem_arena) {
+    assert(elems || keys.elem_cnt == 0);
+    assert(elem_size > 0);
+
+    if (keys.elem_cnt == 0) {
+        return true;
+    }
+
+    const size_t temp_mem_arena_offs_init = temp_mem_arena->offs;
+
+    const s_u64_array pairs = PushSortedKeyIndexPairs(keys, temp_mem_arena);
+    t_u8* const elems_copy = pairs.buf_raw ? PushToMemArena(temp_mem_arena, elem_size * keys.elem_cnt, 16) : NULL;
+
+    if (!elems_copy) {
+        RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+        return false;
+    }
+
+    memcpy(elems_copy, elems, elem_size * keys.elem_cnt);
+
+    for (t_s32 i = 0; i < keys.elem_cnt; i++) {
+        const t_s32 src_index = (t_s32)(*U64Elem(pairs, i) & 0xFFFFFFFF);
+        memcpy((t_u8*)elems + (elem_size * i), elems_copy + (elem_size * src_index), elem_size);
+    }
+
+    RewindMemArena(temp_mem_arena, temp_mem_arena_offs_init);
+
+    return true;
+}
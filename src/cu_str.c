@@ -0,0 +1,385 @@
+#include "cu_str.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define INDEX_OF_ANY_CHAR_SIMD_SET_LIMIT 16
+
+// Enough significant digits for any double to round correctly, per the bound used by fast_float and others.
+#define PARSE_R64_DIGIT_LIMIT 768
+
+#ifdef SIMD_SSE2
+static inline t_s32 IndexOfLowestSetBit(const t_u32 n) {
+    assert(n);
+
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, n);
+    return (t_s32)index;
+#else
+    return __builtin_ctz(n);
+#endif
+}
+
+static inline t_s32 IndexOfHighestSetBit(const t_u32 n) {
+    assert(n);
+
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, n);
+    return (t_s32)index;
+#else
+    return 31 - __builtin_clz(n);
+#endif
+}
+#endif
+
+t_s32 IndexOfChar(const s_char_array_view str, const char c) {
+    t_s32 i = 0;
+
+#ifdef SIMD_SSE2
+    const __m128i needle = _mm_set1_epi8(c);
+
+    for (; i + 16 <= str.elem_cnt; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(str.buf_raw + i));
+        const t_u32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+
+        if (mask) {
+            return i + IndexOfLowestSetBit(mask);
+        }
+    }
+#endif
+
+    for (; i < str.elem_cnt; i++) {
+        if (str.buf_raw[i] == c) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+t_s32 LastIndexOfChar(const s_char_array_view str, const char c) {
+    t_s32 end = str.elem_cnt;
+
+#ifdef SIMD_SSE2
+    const __m128i needle = _mm_set1_epi8(c);
+
+    for (; end >= 16; end -= 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(str.buf_raw + end - 16));
+        const t_u32 mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+
+        if (mask) {
+            return end - 16 + IndexOfHighestSetBit(mask);
+        }
+    }
+#endif
+
+    for (t_s32 i = end - 1; i >= 0; i--) {
+        if (str.buf_raw[i] == c) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+t_s32 IndexOfAnyChar(const s_char_array_view str, const s_char_array_view set) {
+    if (set.elem_cnt == 0) {
+        return -1;
+    }
+
+    // Larger sets are checked through a lookup table instead, as comparing against each character stops paying off.
+    if (set.elem_cnt > INDEX_OF_ANY_CHAR_SIMD_SET_LIMIT) {
+        bool in_set[256] = {0};
+
+        for (t_s32 j = 0; j < set.elem_cnt; j++) {
+            in_set[(t_u8)set.buf_raw[j]] = true;
+        }
+
+        for (t_s32 i = 0; i < str.elem_cnt; i++) {
+            if (in_set[(t_u8)str.buf_raw[i]]) {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    t_s32 i = 0;
+
+#ifdef SIMD_SSE2
+    __m128i needles[INDEX_OF_ANY_CHAR_SIMD_SET_LIMIT];
+
+    for (t_s32 j = 0; j < set.elem_cnt; j++) {
+        needles[j] = _mm_set1_epi8(set.buf_raw[j]);
+    }
+
+    for (; i + 16 <= str.elem_cnt; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(str.buf_raw + i));
+        __m128i matches = _mm_cmpeq_epi8(block, needles[0]);
+
+        for (t_s32 j = 1; j < set.elem_cnt; j++) {
+            matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, needles[j]));
+        }
+
+        const t_u32 mask = _mm_movemask_epi8(matches);
+
+        if (mask) {
+            return i + IndexOfLowestSetBit(mask);
+        }
+    }
+#endif
+
+    for (; i < str.elem_cnt; i++) {
+        for (t_s32 j = 0; j < set.elem_cnt; j++) {
+            if (str.buf_raw[i] == set.buf_raw[j]) {
+                return i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+t_s32 CountChar(const s_char_array_view str, const char c) {
+    t_s32 cnt = 0;
+    t_s32 i = 0;
+
+#ifdef SIMD_SSE2
+    const __m128i needle = _mm_set1_epi8(c);
+    const __m128i zero = _mm_setzero_si128();
+
+    // Matches are tallied per byte lane, which is then summed up before any lane can overflow.
+    while (i + 16 <= str.elem_cnt) {
+        __m128i tallies = zero;
+
+        for (t_s32 j = 0; j < 255 && i + 16 <= str.elem_cnt; j++, i += 16) {
+            const __m128i block = _mm_loadu_si128((const __m128i*)(str.buf_raw + i));
+            tallies = _mm_sub_epi8(tallies, _mm_cmpeq_epi8(block, needle));
+        }
+
+        const __m128i sums = _mm_sad_epu8(tallies, zero);
+        cnt += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+    }
+#endif
+
+    for (; i < str.elem_cnt; i++) {
+        cnt += str.buf_raw[i] == c;
+    }
+
+    return cnt;
+}
+
+bool SplitStrNext(s_char_array_view* const remaining, const char delim, s_char_array_view* const token) {
+    // An empty view is only exhausted once its buffer is cleared, so that a trailing delimiter still gives a final empty token.
+    if (!remaining->buf_raw) {
+        return false;
+    }
+
+    const t_s32 delim_index = IndexOfChar(*remaining, delim);
+
+    if (delim_index == -1) {
+        *token = *remaining;
+        *remaining = (s_char_array_view){0};
+    } else {
+        *token = CharArrayViewSlice(*remaining, 0, delim_index);
+        *remaining = CharArrayViewSlice(*remaining, delim_index + 1, remaining->elem_cnt);
+    }
+
+    return true;
+}
+
+bool SplitStrNextLine(s_char_array_view* const remaining, s_char_array_view* const line) {
+    // Unlike other delimiters, a trailing line ending doesn't start another line.
+    if (remaining->elem_cnt == 0) {
+        return false;
+    }
+
+    if (!SplitStrNext(remaining, '\n', line)) {
+        return false;
+    }
+
+    if (line->elem_cnt > 0 && line->buf_raw[line->elem_cnt - 1] == '\r') {
+        line->elem_cnt--;
+    }
+
+    return true;
+}
+
+bool ParseS64(const s_char_array_view str, t_s64* const val) {
+    t_s32 i = 0;
+    bool neg = false;
+
+    if (i < str.elem_cnt && (str.buf_raw[i] == '-' || str.buf_raw[i] == '+')) {
+        neg = str.buf_raw[i] == '-';
+        i++;
+    }
+
+    if (i == str.elem_cnt) {
+        return false;
+    }
+
+    // Accumulating the magnitude unsigned so that INT64_MIN can be represented.
+    const t_u64 limit = neg ? (t_u64)INT64_MAX + 1 : (t_u64)INT64_MAX;
+    t_u64 mag = 0;
+
+    for (; i < str.elem_cnt; i++) {
+        const t_u32 digit = (t_u32)(str.buf_raw[i] - '0');
+
+        if (digit > 9 || mag > (limit - digit) / 10) {
+            return false;
+        }
+
+        mag = (mag * 10) + digit;
+    }
+
+    *val = neg ? (t_s64)(0 - mag) : (t_s64)mag;
+
+    return true;
+}
+
+bool ParseS32(const s_char_array_view str, t_s32* const val) {
+    t_s64 val_s64;
+
+    if (!ParseS64(str, &val_s64) || val_s64 < INT32_MIN || val_s64 > INT32_MAX) {
+        return false;
+    }
+
+    *val = (t_s32)val_s64;
+
+    return true;
+}
+
+bool ParseR64(const s_char_array_view str, t_r64* const val) {
+    // Fast path (Clinger's): if the digits fit exactly in a double's mantissa and the power of ten is exact too, one multiply or divide gives a correctly rounded result.
+    static const t_r64 pows_of_10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    t_s32 i = 0;
+    bool neg = false;
+
+    if (i < str.elem_cnt && (str.buf_raw[i] == '-' || str.buf_raw[i] == '+')) {
+        neg = str.buf_raw[i] == '-';
+        i++;
+    }
+
+    t_u64 mantissa = 0;
+    t_s32 digit_cnt = 0;
+    t_s32 exp = 0;
+    bool any_digits = false;
+
+    for (; i < str.elem_cnt && str.buf_raw[i] >= '0' && str.buf_raw[i] <= '9'; i++) {
+        mantissa = (mantissa * 10) + (str.buf_raw[i] - '0');
+        digit_cnt += mantissa > 0;
+        any_digits = true;
+    }
+
+    if (i < str.elem_cnt && str.buf_raw[i] == '.') {
+        i++;
+
+        for (; i < str.elem_cnt && str.buf_raw[i] >= '0' && str.buf_raw[i] <= '9'; i++) {
+            mantissa = (mantissa * 10) + (str.buf_raw[i] - '0');
+            digit_cnt += mantissa > 0;
+            exp--;
+            any_digits = true;
+        }
+    }
+
+    if (!any_digits) {
+        return false;
+    }
+
+    if (i < str.elem_cnt && (str.buf_raw[i] == 'e' || str.buf_raw[i] == 'E')) {
+        t_s64 exp_explicit;
+
+        if (!ParseS64(CharArrayViewSlice(str, i + 1, str.elem_cnt), &exp_explicit) || exp_explicit < -100000 || exp_explicit > 100000) {
+            return false;
+        }
+
+        exp += (t_s32)exp_explicit;
+        i = str.elem_cnt;
+    }
+
+    if (i != str.elem_cnt) {
+        return false;
+    }
+
+    const t_s32 pows_of_10_cnt = STATIC_ARRAY_LEN(pows_of_10);
+
+    if (digit_cnt <= 15 && mantissa <= ((t_u64)1 << 53) && exp > -pows_of_10_cnt && exp < pows_of_10_cnt) {
+        t_r64 result = (t_r64)mantissa;
+        result = exp < 0 ? result / pows_of_10[-exp] : result * pows_of_10[exp];
+        *val = neg ? -result : result;
+        return true;
+    }
+
+    // Slow path, for long mantissas and large exponents. The view has been validated, so it only needs to be rewritten as plain digits and an exponent for strtod.
+    // Leaving out the decimal point means the locale can't change how it gets read, and digits past the limit only matter in whether any are nonzero, so they get folded into one.
+    char buf[PARSE_R64_DIGIT_LIMIT + 32];
+    t_s32 buf_len = 0;
+    t_s64 buf_exp = exp;
+    t_s32 sig_digit_cnt = 0;
+    bool truncated = false;
+
+    if (neg) {
+        buf[buf_len] = '-';
+        buf_len++;
+    }
+
+    for (t_s32 j = 0; j < str.elem_cnt && str.buf_raw[j] != 'e' && str.buf_raw[j] != 'E'; j++) {
+        const char c = str.buf_raw[j];
+
+        if (c < '0' || c > '9' || (c == '0' && sig_digit_cnt == 0)) {
+            continue;
+        }
+
+        if (sig_digit_cnt < PARSE_R64_DIGIT_LIMIT) {
+            buf[buf_len] = c;
+            buf_len++;
+            sig_digit_cnt++;
+        } else {
+            buf_exp++;
+            truncated |= c != '0';
+        }
+    }
+
+    if (sig_digit_cnt == 0) {
+        *val = neg ? -0.0 : 0.0;
+        return true;
+    }
+
+    if (truncated) {
+        buf[buf_len] = '1';
+        buf_len++;
+        buf_exp--;
+    }
+
+    snprintf(buf + buf_len, sizeof(buf) - buf_len, "e%lld", (long long)buf_exp);
+
+    *val = strtod(buf, NULL);
+
+    return true;
+}
+
+bool ParseR32(const s_char_array_view str, t_r32* const val) {
+    t_r64 val_r64;
+
+    if (!ParseR64(str, &val_r64)) {
+        return false;
+    }
+
+    *val = (t_r32)val_r64;
+
+    return true;
+}